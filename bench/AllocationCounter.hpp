@@ -0,0 +1,13 @@
+#ifndef ALLOCATION_COUNTER_HPP
+#define ALLOCATION_COUNTER_HPP
+
+#include <cstdint>
+
+// Counts global operator new calls while enabled. The replacement operators
+// live in their own translation unit so they are never inlined into callers
+namespace AllocationCounter {
+    void setEnabled(bool enabled);
+    uint64_t count();
+}
+
+#endif // ALLOCATION_COUNTER_HPP
@@ -0,0 +1,32 @@
+#include "AllocationCounter.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+    std::atomic<bool> s_Enabled{false};
+    std::atomic<uint64_t> s_Count{0};
+}
+
+void AllocationCounter::setEnabled(bool enabled) {
+    s_Enabled = enabled;
+}
+
+uint64_t AllocationCounter::count() {
+    return s_Count;
+}
+
+void* operator new(std::size_t size) {
+    if (s_Enabled.load(std::memory_order_relaxed)) s_Count.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
@@ -0,0 +1,304 @@
+// Chunk storage microbenchmarks, built with -DVOXEL_BUILD_BENCH=ON.
+// The block layout is fixed at compile time, so layout numbers only mean
+// something side by side: build once with VOXEL_CHUNK_MORTON=OFF and once
+// with ON, then compare the two outputs.
+#include "AllocationCounter.hpp"
+#include "Chunk.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace {
+    constexpr int kChunkCount = 256;
+    constexpr int kRaysPerChunk = 256;
+    constexpr int kDecodeChunks = 64;
+    constexpr int kDecodeRounds = 200;
+
+    using Clock = std::chrono::steady_clock;
+
+    double nanosSince(Clock::time_point start) {
+        return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+    }
+
+    // Keeps the optimizer from dropping reads whose result is otherwise unused
+    volatile uint64_t g_Sink = 0;
+
+    // Terrain-like contents: layered columns of varying height with random
+    // caves, so the chunks end up in a mix of storage modes
+    BlockType terrainBlock(std::mt19937& rng, int y, int surface) {
+        if (y > surface) return BlockType::Air;
+        if (rng() % 10 == 0) return BlockType::Air; // Caves
+        if (y == surface) return BlockType::Grass;
+        if (y >= surface - 2) return BlockType::Dirt;
+        return BlockType::Stone;
+    }
+
+    struct Chunks {
+        std::vector<std::unique_ptr<Chunk>> chunks;
+        double fillNanos = 0.0; // setBlock calls only
+        uint64_t voxelsSet = 0;
+    };
+
+    // One chunk of terrain in x-z-y order, returns the number of solid blocks
+    int fillTerrain(std::mt19937& rng, std::vector<BlockType>& blocks) {
+        // Surface somewhere in the chunk, sloped so columns differ
+        int base = rng() % Chunk::kChunkHeight;
+        int n = 0;
+        int solid = 0;
+        for (int y = 0; y < Chunk::kChunkHeight; y++) {
+            for (int z = 0; z < Chunk::kChunkDepth; z++) {
+                for (int x = 0; x < Chunk::kChunkWidth; x++) {
+                    int surface = (base + (x + z) / 4) % Chunk::kChunkHeight;
+                    blocks[n] = terrainBlock(rng, y, surface);
+                    solid += blocks[n++] != BlockType::Air;
+                }
+            }
+        }
+        return solid;
+    }
+
+    // Distinct seeds give distinct contents, so meshing never hits the MeshCache
+    Chunks makeChunks(uint32_t seed) {
+        Chunks result;
+        std::mt19937 rng(seed);
+        std::vector<BlockType> blocks(Chunk::kChunkVolume);
+
+        // Chunk's constructor logs every chunk
+        std::cout.setstate(std::ios::failbit);
+        for (int i = 0; i < kChunkCount; i++) {
+            int solid = fillTerrain(rng, blocks);
+            auto chunk = std::make_unique<Chunk>(nullptr, glm::vec3(i * Chunk::kChunkWidth, 0, 0),
+                                                 Chunk::storageModeForFill(solid));
+            // Same x-z-y visiting order as the chunk generator
+            auto start = Clock::now();
+            int n = 0;
+            for (int y = 0; y < Chunk::kChunkHeight; y++) {
+                for (int z = 0; z < Chunk::kChunkDepth; z++) {
+                    for (int x = 0; x < Chunk::kChunkWidth; x++) {
+                        if (blocks[n] != BlockType::Air) {
+                            chunk->setBlock(x, y, z, blocks[n]);
+                            result.voxelsSet++;
+                        }
+                        n++;
+                    }
+                }
+            }
+            result.fillNanos += nanosSince(start);
+            result.chunks.push_back(std::move(chunk));
+        }
+        std::cout.clear();
+
+        return result;
+    }
+
+    void printModes(const Chunks& set) {
+        int modes[4] = {0, 0, 0, 0};
+        for (const auto& chunk : set.chunks) modes[static_cast<int>(chunk->getStorageMode())]++;
+        std::printf("chunks: %d dense, %d sparse, %d palette, %d uniform\n", modes[0], modes[1], modes[2], modes[3]);
+    }
+
+    // Every voxel in x-z-y order, the way visibility and generation code walks a chunk
+    void benchSweep(const Chunks& set) {
+        uint64_t sum = 0;
+        auto start = Clock::now();
+        for (const auto& chunk : set.chunks) {
+            for (int y = 0; y < Chunk::kChunkHeight; y++) {
+                for (int z = 0; z < Chunk::kChunkDepth; z++) {
+                    for (int x = 0; x < Chunk::kChunkWidth; x++) {
+                        sum += static_cast<uint64_t>(chunk->getBlock(x, y, z));
+                    }
+                }
+            }
+        }
+        double nanos = nanosSince(start);
+        g_Sink = g_Sink + sum;
+        std::printf("%-22s %8.2f ns/voxel\n", "getBlock sweep", nanos / (double(kChunkCount) * Chunk::kChunkVolume));
+    }
+
+    struct Ray {
+        glm::vec3 origin;
+        glm::vec3 dir;
+    };
+
+    // Voxel-by-voxel DDA from random points in random directions until a
+    // solid block or the chunk boundary, the access pattern of a raycast
+    void benchRays(const Chunks& set) {
+        std::mt19937 rng(7);
+        std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+        const glm::ivec3 size(Chunk::kChunkWidth, Chunk::kChunkHeight, Chunk::kChunkDepth);
+
+        std::vector<Ray> rays(kRaysPerChunk);
+        for (Ray& ray : rays) {
+            ray.origin = glm::vec3(unit(rng), unit(rng), unit(rng)) * glm::vec3(size);
+            ray.dir = glm::normalize(glm::vec3(unit(rng), unit(rng), unit(rng)) * 2.0f - glm::vec3(1.0f));
+        }
+
+        uint64_t steps = 0;
+        uint64_t hits = 0;
+        auto start = Clock::now();
+        for (const auto& chunk : set.chunks) {
+            for (const Ray& ray : rays) {
+                glm::ivec3 voxel = glm::ivec3(glm::floor(ray.origin));
+                glm::ivec3 step;
+                glm::vec3 tMax;
+                glm::vec3 tDelta;
+                for (int axis = 0; axis < 3; axis++) {
+                    step[axis] = ray.dir[axis] >= 0.0f ? 1 : -1;
+                    tDelta[axis] = ray.dir[axis] != 0.0f ? std::abs(1.0f / ray.dir[axis]) : INFINITY;
+                    float boundary = voxel[axis] + (step[axis] > 0 ? 1.0f : 0.0f);
+                    tMax[axis] = ray.dir[axis] != 0.0f ? (boundary - ray.origin[axis]) / ray.dir[axis] : INFINITY;
+                }
+
+                while (voxel.x >= 0 && voxel.y >= 0 && voxel.z >= 0 &&
+                       voxel.x < size.x && voxel.y < size.y && voxel.z < size.z) {
+                    steps++;
+                    if (chunk->getBlock(voxel.x, voxel.y, voxel.z) != BlockType::Air) {
+                        hits++;
+                        break;
+                    }
+                    int axis = (tMax.x < tMax.y) ? (tMax.x < tMax.z ? 0 : 2) : (tMax.y < tMax.z ? 1 : 2);
+                    voxel[axis] += step[axis];
+                    tMax[axis] += tDelta[axis];
+                }
+            }
+        }
+        double nanos = nanosSince(start);
+        g_Sink = g_Sink + hits;
+        std::printf("%-22s %8.2f ns/step (%.1f steps/ray)\n", "getBlock ray walk", nanos / steps,
+                    double(steps) / (double(kChunkCount) * kRaysPerChunk));
+    }
+
+    // Dense storage is a plain buffer, wrapped in the interface of the other storages
+    struct DenseStorage {
+        std::vector<BlockType> blocks;
+
+        explicit DenseStorage(int volume) : blocks(volume, BlockType::Air) {}
+        void setBlock(int index, BlockType type) { blocks[index] = type; }
+        BlockType getBlock(int index) const { return blocks[index]; }
+        void decode(BlockType* out) const { std::copy(blocks.begin(), blocks.end(), out); }
+    };
+
+    // Terrain chunks in one storage type. sparseOnly keeps about one solid
+    // block in 16, below kSparseEnterBlocks like every chunk that stays sparse
+    template <typename Storage>
+    std::vector<std::unique_ptr<Storage>> makeStorages(uint32_t seed, bool sparseOnly) {
+        std::mt19937 rng(seed);
+        std::vector<BlockType> blocks(Chunk::kChunkVolume);
+        std::vector<std::unique_ptr<Storage>> storages;
+        for (int i = 0; i < kDecodeChunks; i++) {
+            fillTerrain(rng, blocks);
+            auto storage = std::make_unique<Storage>(Chunk::kChunkVolume);
+            int n = 0;
+            for (int y = 0; y < Chunk::kChunkHeight; y++) {
+                for (int z = 0; z < Chunk::kChunkDepth; z++) {
+                    for (int x = 0; x < Chunk::kChunkWidth; x++) {
+                        BlockType type = blocks[n++];
+                        if (sparseOnly && rng() % 16) type = BlockType::Air;
+                        if (type != BlockType::Air) storage->setBlock(ChunkLayout::index(x, y, z), type);
+                    }
+                }
+            }
+            storages.push_back(std::move(storage));
+        }
+        return storages;
+    }
+
+    // A voxel at a time through getBlock, the way snapshots used to be filled,
+    // against the storage's bulk decoder that Chunk::decodeBlocks now calls.
+    // The old path also went through Chunk::getBlock's mode switch, not counted here
+    template <typename Storage>
+    void benchDecode(const char* name, const std::vector<std::unique_ptr<Storage>>& storages) {
+        static std::array<BlockType, Chunk::kChunkVolume> out;
+        uint64_t sum = 0;
+
+        auto start = Clock::now();
+        for (int round = 0; round < kDecodeRounds; round++) {
+            for (const auto& storage : storages) {
+                int n = 0;
+                for (int y = 0; y < Chunk::kChunkHeight; y++) {
+                    for (int z = 0; z < Chunk::kChunkDepth; z++) {
+                        for (int x = 0; x < Chunk::kChunkWidth; x++) {
+                            out[n++] = storage->getBlock(ChunkLayout::index(x, y, z));
+                        }
+                    }
+                }
+                sum += static_cast<uint64_t>(out[round]);
+            }
+        }
+        double perVoxelNanos = nanosSince(start);
+
+        start = Clock::now();
+        for (int round = 0; round < kDecodeRounds; round++) {
+            for (const auto& storage : storages) {
+                storage->decode(out.data());
+                sum += static_cast<uint64_t>(out[round]);
+            }
+        }
+        double bulkNanos = nanosSince(start);
+        g_Sink = g_Sink + sum;
+
+        double decodes = double(kDecodeRounds) * storages.size();
+        std::printf("%-22s %8.2f -> %6.2f us/chunk (x%.1f)\n", name, perVoxelNanos / 1000.0 / decodes,
+                    bulkNanos / 1000.0 / decodes, perVoxelNanos / bulkNanos);
+    }
+
+    // Full CPU meshing at LOD 0 without neighbors. Each chunk is meshed once so
+    // every build misses the MeshCache and reads its blocks through takeSnapshot.
+    // Allocations are counted per build: face emission itself makes none, what
+    // is left is a fixed set of result buffers that doesn't grow with the quads
+    void benchMesh(const Chunks& set) {
+        const Chunk::Neighbors neighbors{};
+        const Chunk::NeighborLods neighborLods{};
+        size_t quads = 0;
+        uint64_t allocations = 0;
+        uint64_t minAllocations = UINT64_MAX;
+        uint64_t maxAllocations = 0;
+        double nanos = 0.0;
+        for (const auto& chunk : set.chunks) {
+            uint64_t allocationsBefore = AllocationCounter::count();
+            AllocationCounter::setEnabled(true);
+            auto start = Clock::now();
+            Chunk::MeshBuild build = chunk->buildMesh(neighbors, neighborLods, 0, Chunk::kAllFaces, {});
+            nanos += nanosSince(start);
+            AllocationCounter::setEnabled(false);
+
+            uint64_t count = AllocationCounter::count() - allocationsBefore;
+            allocations += count;
+            minAllocations = std::min(minAllocations, count);
+            maxAllocations = std::max(maxAllocations, count);
+            quads += build.merged.indices.size() / 6;
+        }
+        g_Sink = g_Sink + quads;
+        std::printf("%-22s %8.2f us/chunk (%zu quads)\n", "buildMesh", nanos / 1000.0 / kChunkCount, quads);
+        std::printf("%-22s %8.2f per mesh (min %llu, max %llu, %.0f quads/mesh)\n", "buildMesh allocations",
+                    double(allocations) / kChunkCount, (unsigned long long)minAllocations,
+                    (unsigned long long)maxAllocations, double(quads) / kChunkCount);
+    }
+}
+
+int main() {
+    std::printf("layout: %s, chunk %dx%dx%d\n", ChunkLayout::kMorton ? "morton" : "linear",
+                Chunk::kChunkWidth, Chunk::kChunkHeight, Chunk::kChunkDepth);
+
+    Chunks terrain = makeChunks(1);
+    printModes(terrain);
+    std::printf("%-22s %8.2f ns/voxel\n", "setBlock fill", terrain.fillNanos / terrain.voxelsSet);
+    benchSweep(terrain);
+    benchRays(terrain);
+    benchMesh(terrain);
+
+    std::printf("decode, getBlock per voxel -> bulk:\n");
+    benchDecode("  dense", makeStorages<DenseStorage>(2, false));
+    benchDecode("  sparse", makeStorages<SparseChunkData>(3, true));
+    benchDecode("  palette", makeStorages<PaletteChunkData>(4, false));
+
+    return 0;
+}
@@ -0,0 +1,20 @@
+#ifndef BIT_UTILS_HPP
+#define BIT_UTILS_HPP
+
+#include <cstdint>
+
+inline int popcount64(uint64_t value) {
+    return __builtin_popcountll(value);
+}
+
+// Index of the lowest set bit. value must be non-zero
+inline int countTrailingZeros64(uint64_t value) {
+    return __builtin_ctzll(value);
+}
+
+// Mask of the bits below `bit` (0..63)
+inline uint64_t lowBitsMask(int bit) {
+    return (uint64_t(1) << bit) - 1;
+}
+
+#endif // BIT_UTILS_HPP
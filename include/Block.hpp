@@ -3,80 +3,78 @@
 #define BLOCK_HPP
 
 #include <glm/glm.hpp>
-#include <vector>
+#include <array>
+#include <cstdint>
 #include <MeshPack.hpp>
 #include <BlockType.hpp>
 #include <BlockTextureMap.hpp>
+#include <BlockRegistry.hpp>
 
-// 16 x 16 tile texture atlas
+// 16 x 16 tile texture atlas. Tiles are resolved in fragment.glsl
 static constexpr float TILE_SIZE = 1.0f / 16.0f;
+static constexpr int ATLAS_TILES_PER_ROW = 16;
+
+// Axes (0 = x, 1 = y, 2 = z) each face lies across. Texture u/v run along
+// u/v (see vertex.glsl), so stretching a face along them keeps UVs upright.
+struct FaceAxes {
+    int normal;
+    int u;
+    int v;
+};
+
+static constexpr FaceAxes faceAxes[6] = {
+    {2, 0, 1}, // -z
+    {2, 0, 1}, // +z
+    {0, 2, 1}, // -x
+    {0, 2, 1}, // +x
+    {1, 0, 2}, // -y
+    {1, 0, 2}  // +y
+};
 
 // Face definition indices
-static const std::vector<unsigned int> baseFaceIndices = {
-    0, 1, 2, // triangle 1 
+static constexpr unsigned int baseFaceIndices[6] = {
+    0, 1, 2, // triangle 1
     2, 3, 0  // triangle 2
 };
 
-// For each face, we store 4 vertices. Each vertex has 5 floats:
-//  x, y, z, u, v
-// where (u,v) is in the 0..1 range for that face.
-static const std::vector<float> baseFaceVertices[6] = {
-    // Negative Z face
-    {
-        // x     y      z     u     v 
-        -0.5f,  0.0f, -0.5f, 0.0f, 0.0f, // bottom-left
-        0.5f,  0.0f, -0.5f, 1.0f, 0.0f, // bottom-right
-        0.5f,  1.0f, -0.5f, 1.0f, 1.0f, // top-right
-        -0.5f,  1.0f, -0.5f, 0.0f, 1.0f // top-left
-    },
-
+// For each face, the 4 corners of a unit block in PackedVertex space: 0 or 1
+// per axis, with x and z measured from the block's -0.5 edge.
+static constexpr glm::ivec3 baseFaceCorners[6][4] = {
+    // Negative Z face: bottom-left, bottom-right, top-right, top-left
+    {{0, 0, 0}, {1, 0, 0}, {1, 1, 0}, {0, 1, 0}},
     // Positive Z face
-    {
-        -0.5f,  0.0f,  0.5f, 0.0f, 0.0f,
-        -0.5f,  1.0f,  0.5f, 0.0f, 1.0f,
-        0.5f,  1.0f,  0.5f, 1.0f, 1.0f,
-        0.5f,  0.0f,  0.5f, 1.0f, 0.0f,
-    },
-
+    {{0, 0, 1}, {0, 1, 1}, {1, 1, 1}, {1, 0, 1}},
     // Negative X face
-    {
-        -0.5f,  0.0f, -0.5f, 0.0f, 0.0f,
-        -0.5f,  1.0f, -0.5f, 0.0f, 1.0f,
-        -0.5f,  1.0f,  0.5f, 1.0f, 1.0f,
-        -0.5f,  0.0f,  0.5f, 1.0f, 0.0f,
-    },
-
+    {{0, 0, 0}, {0, 1, 0}, {0, 1, 1}, {0, 0, 1}},
     // Positive X face
-    {
-        0.5f,  0.0f, -0.5f, 0.0f, 0.0f,
-        0.5,  0.0f,  0.5f, 1.0f, 0.0f,
-        0.5f,  1.0f,  0.5f, 1.0f, 1.0f,
-        0.5f,  1.0f, -0.5f, 0.0f, 1.0f,
-    },
-
+    {{1, 0, 0}, {1, 0, 1}, {1, 1, 1}, {1, 1, 0}},
     // Negative Y face
-    {
-        -0.5f,  0.0f, -0.5f, 0.0f, 0.0f,
-        -0.5f,  0.0f,  0.5f, 0.0f, 1.0f,
-        0.5f,  0.0f,  0.5f, 1.0f, 1.0f,
-        0.5f,  0.0f, -0.5f, 1.0f, 0.0f
-    },
-
+    {{0, 0, 0}, {0, 0, 1}, {1, 0, 1}, {1, 0, 0}},
     // Positive Y face
-    {
-        -0.5f,  1.0f, -0.5f, 0.0f, 0.0f,
-        0.5f,  1.0f, -0.5f, 1.0f, 0.0f,
-        0.5f,  1.0f,  0.5f, 1.0f, 1.0f,
-        -0.5f,  1.0f,  0.5f, 0.0f, 1.0f
-    }
+    {{0, 1, 0}, {1, 1, 0}, {1, 1, 1}, {0, 1, 1}}
 };
 
+namespace detail {
+    constexpr std::array<std::array<uint16_t, NUM_FACES>, BLOCK_TYPE_COUNT> makeFaceTileIndices() {
+        std::array<std::array<uint16_t, NUM_FACES>, BLOCK_TYPE_COUNT> table{};
+        for (int type = 0; type < BLOCK_TYPE_COUNT; ++type) {
+            for (int face = 0; face < NUM_FACES; ++face) {
+                const std::pair<int, int>& tile = blockRegistry[type].faceTiles[face];
+                table[type][face] = static_cast<uint16_t>(tile.first + tile.second * ATLAS_TILES_PER_ROW);
+            }
+        }
+        return table;
+    }
+}
+
+// Atlas tile index (tileX + tileY * 16) per BlockType and face, as stored in PackedVertex
+inline constexpr auto faceTileIndices = detail::makeFaceTileIndices();
+
+// Stateless block helpers. Per-type data lives in the BlockRegistry, chunks
+// pass in the block type and its chunk-local position when meshing.
 class Block {
     public:
-        BlockType type;
-    public:
-        static std::vector<unsigned int> getFaceIndices();
-        static std::vector<float> getFaceVertices();
+        static const BlockInfo& getInfo(BlockType type);
         // Order of faces we assume:
         //  0 -> Negative Z
         //  1 -> Positive Z
@@ -84,14 +82,13 @@ class Block {
         //  3 -> Positive X
         //  4 -> Negative Y
         //  5 -> Positive Y
-        void defineRenderedFaces(MeshPack& pack, const std::vector<bool>& visibleFaces);
-
-        Block(BlockType type, const glm::vec3& position);
-        virtual ~Block() = default;
+        // Emits one face of the block at position (its coordinate inside the chunk)
+        // stretched over width x height blocks along the face's u/v axes (see faceAxes).
+        // Doesn't allocate as long as the pack has been reserved for the faces being added.
+        static void defineFace(MeshPack& pack, int face, int tileIndex,
+                               const glm::ivec3& position, int width = 1, int height = 1);
 
-    protected:
-        glm::vec3 m_Position;
-        // std::vector<float> m_FaceData;
+        Block() = delete;
 };
 
 #endif // BLOCK_HPP
@@ -0,0 +1,54 @@
+#ifndef BLOCK_REGISTRY_HPP
+#define BLOCK_REGISTRY_HPP
+
+#include "BlockType.hpp"
+#include "BlockTextureMap.hpp"
+
+#include <array>
+#include <utility>
+
+// Shared, per-type block description. Chunks only store BlockType values and
+// look everything else up here instead of keeping an object per voxel.
+struct BlockInfo {
+    bool rendered; // false for air, the mesher skips these entirely
+    bool opaque;   // hides the faces of neighbouring blocks
+    std::array<std::pair<int, int>, NUM_FACES> faceTiles; // atlas tile per face
+};
+
+static constexpr int BLOCK_TYPE_COUNT = UNIQUE_BLOCKS + 1; // + Air
+
+namespace detail {
+    constexpr BlockInfo makeBlockInfo(BlockType type) {
+        if (type == BlockType::Air) {
+            return BlockInfo{false, false, {}};
+        }
+
+        return BlockInfo{true, true, {{
+            getFaceTile(type, 0), getFaceTile(type, 1), getFaceTile(type, 2),
+            getFaceTile(type, 3), getFaceTile(type, 4), getFaceTile(type, 5)
+        }}};
+    }
+}
+
+// Indexed by BlockType (as integer)
+inline constexpr std::array<BlockInfo, BLOCK_TYPE_COUNT> blockRegistry = {{
+    detail::makeBlockInfo(BlockType::Air),
+    detail::makeBlockInfo(BlockType::Stone),
+    detail::makeBlockInfo(BlockType::Grass),
+    detail::makeBlockInfo(BlockType::Dirt),
+}};
+
+constexpr const BlockInfo& getBlockInfo(BlockType type) {
+    return blockRegistry[static_cast<int>(type)];
+}
+
+// True when a block is rendered exactly when it is opaque, so a chunk's
+// opaque mask can double as its rendered mask when culling faces
+constexpr bool renderedMatchesOpaque() {
+    for (const BlockInfo& info : blockRegistry) {
+        if (info.rendered != info.opaque) return false;
+    }
+    return true;
+}
+
+#endif // BLOCK_REGISTRY_HPP
@@ -11,7 +11,7 @@ static constexpr int NUM_FACES = 6;
 static constexpr int UNIQUE_BLOCKS = 3;
 
 // Indexed by BlockType (as integer) and face index
-inline static const std::array<std::array<std::pair<int, int>, NUM_FACES>, UNIQUE_BLOCKS> blockTextureMap = {{
+inline constexpr std::array<std::array<std::pair<int, int>, NUM_FACES>, UNIQUE_BLOCKS> blockTextureMap = {{
     // Stone
     {{{3, 0}, {3, 0}, {3, 0}, {3, 0}, {3, 0}, {3, 0}}},
 
@@ -22,7 +22,7 @@ inline static const std::array<std::array<std::pair<int, int>, NUM_FACES>, UNIQU
         {{{2, 0}, {2, 0}, {2, 0}, {2, 0}, {2, 0}, {2, 0}}}
 }};
 
-inline std::pair<int, int> getFaceTile(BlockType type, int faceIndex) {
+constexpr std::pair<int, int> getFaceTile(BlockType type, int faceIndex) {
     return blockTextureMap[static_cast<int>(type) - 1][faceIndex];
 }
 
@@ -1,7 +1,10 @@
 #ifndef BLOCKTYPE_HPP
 #define BLOCKTYPE_HPP
 
-enum class BlockType{
+#include <cstdint>
+
+// Stored as a single byte so dense/palette chunk storage stays compact
+enum class BlockType : uint8_t {
     Air,
     Stone,
     Grass,
@@ -12,6 +12,8 @@ class Camera {
     public:
         glm::vec3 getPosition() const;
         glm::mat4 getViewMatrix() const;
+        // View matrix with the camera at the origin, for geometry placed relative to the camera
+        glm::mat4 getRotationViewMatrix() const;
         glm::mat4 getProjectionMatrix(float aspectRatio) const;
         void processKeyboard(bool* keys, float deltaTime);
         void processMouseMovement(float xoffset, float yoffset);
@@ -1,22 +1,37 @@
 #ifndef CHUNK_HPP
 #define CHUNK_HPP
 
+#include "ChunkConfig.hpp"
+#include "ChunkLayout.hpp"
 #include "Mesh.hpp"
 #include "Block.hpp"
 #include "SparseChunkData.hpp"
+#include "PaletteChunkData.hpp"
+#include "SlabPool.hpp"
+#include "FaceCulling.hpp"
+#include "ChunkSnapshot.hpp"
 
 #include <glm/glm.hpp>
+#include <array>
 #include <vector>
-#include <optional>
 #include <memory>
 
 class World;
 
-class Chunk {
+// Chunk objects and their block buffers come from slab pools (see SlabPool.hpp),
+// so loading and unloading chunks recycles memory instead of hitting the heap
+class Chunk : public PooledObject<Chunk> {
     public:
-        inline static constexpr int kChunkWidth = 16;
-        inline static constexpr int kChunkHeight = 16;
-        inline static constexpr int kChunkDepth = 16;
+        using BlockBuffer = std::vector<BlockType, PoolAllocator<BlockType>>;
+
+        inline static constexpr const char* kPoolName = "Chunk";
+        inline static constexpr int kChunkWidth = ChunkConfig::kWidth;
+        inline static constexpr int kChunkHeight = ChunkConfig::kHeight;
+        inline static constexpr int kChunkDepth = ChunkConfig::kDepth;
+        inline static constexpr int kChunkVolume = kChunkWidth * kChunkHeight * kChunkDepth;
+        inline static constexpr int kOpaqueMaskWords = kChunkVolume / 64;
+        static_assert(64 % kChunkWidth == 0, "Opaque mask rows must not straddle 64-bit words");
+        static_assert(kOpaqueMaskWords == FaceCulling::kWords, "Face culling works on the opaque mask layout");
 
         // Offsets for neighbor cells in the order of faces:
         inline static constexpr glm::ivec3 neighborOffsets[6] = {
@@ -28,40 +43,178 @@ class Chunk {
             { 0,  1,  0}  // +y
         };
 
+        inline static constexpr uint8_t kAllFaces = 0b111111;
+
+        // LOD n meshes the chunk from (2^n)^3 cells of majority blocks. The coarsest
+        // cell must still tile the chunk, ChunkConfig keeps every dimension >= 8
+        inline static constexpr int kMaxLod = 3;
+        static_assert(kChunkWidth >= (1 << kMaxLod) && kChunkHeight >= (1 << kMaxLod) &&
+                      kChunkDepth >= (1 << kMaxLod), "Chunk too small for the coarsest LOD");
+
+        // 8^3 brick summary, read straight off the opaque mask (see getBrickState).
+        // ChunkConfig keeps every dimension a power of two >= 8, so bricks tile the chunk
+        inline static constexpr int kBrickSize = 8;
+        inline static constexpr int kBricksX = kChunkWidth / kBrickSize;
+        inline static constexpr int kBricksY = kChunkHeight / kBrickSize;
+        inline static constexpr int kBricksZ = kChunkDepth / kBrickSize;
+
+        enum class BrickState {
+            Empty, // nothing rendered
+            Full,  // every voxel opaque
+            Mixed
+        };
+
         enum class StorageMode {
             Dense,
-            Sparse
+            Sparse,
+            Palette, // bit-packed indices into a per-chunk palette
+            Uniform  // a single block type fills the whole chunk
+        };
+
+        enum class MeshingMode {
+            Naive, // one quad per visible block face
+            Greedy // coplanar faces sharing a texture are merged into rectangles
         };
+
+        // Storage mode migration thresholds. The gaps between enter/exit values
+        // stop a chunk that is edited around a boundary from flipping back and forth.
+        inline static constexpr int kSparseEnterBlocks = kChunkVolume / 16; // Palette/Dense -> Sparse below this
+        inline static constexpr int kSparseExitBlocks = kChunkVolume / 8;   // Sparse -> Palette/Dense above this
+        inline static constexpr int kPaletteEnterTypes = 16;                // Dense -> Palette at or below this
+        inline static constexpr int kPaletteExitTypes = 64;                 // Palette -> Dense above this
+        // Edits a chunk must absorb before it re-evaluates its mode. At least
+        // kSparseExitBlocks so freshly generated chunks never migrate while being populated.
+        inline static constexpr int kMigrationCooldown = kSparseExitBlocks;
     public:
         void setBlock(int x, int y, int z, BlockType type);
         BlockType getBlock(int x, int y, int z) const;
+        // Chunks across each face in neighborOffsets order, nullptr where none is loaded
+        using Neighbors = std::array<const Chunk*, 6>;
+        // LOD of each neighbor when the mesh job was queued, in the same order
+        using NeighborLods = std::array<uint8_t, 6>;
+        // Mesh of each face direction on its own. Immutable once built, so mesh
+        // jobs can reuse the clean directions while the chunk keeps drawing
+        using FaceMeshes = std::array<std::shared_ptr<const MeshPack>, 6>;
+
+        struct MeshBuild {
+            FaceMeshes faces;
+            MeshPack merged;          // faces concatenated in face order, what gets uploaded
+            uint8_t rebuiltFaces = 0; // directions rebuilt by this build
+        };
+
+        // Rebuilds every direction and uploads on the calling (GL) thread, neighbors come from the World
         void generateMesh();
+        // Same, but only the directions marked dirty are rebuilt
         void generateDirtyMesh();
+        // CPU half of meshing. Rebuilds the dirtyFaces directions at the given LOD
+        // and reuses previous for the rest. Only reads this chunk and the given
+        // neighbors, so it can run on a worker thread while none of them is being edited
+        MeshBuild buildMesh(const Neighbors& neighbors, const NeighborLods& neighborLods, uint8_t lod,
+                            uint8_t dirtyFaces, const FaceMeshes& previous) const;
+        // GL half: swaps in the build's sub-meshes and uploads the merged mesh. GL thread only
+        void uploadMesh(MeshBuild&& build);
+        uint8_t getDirtyFaces() const { return m_DirtyFaces; }
+        const FaceMeshes& getFaceMeshes() const { return m_FaceMeshes; }
+        // Drops the mesh and its sub-meshes and marks every direction dirty,
+        // for chunks that are not drawn anymore
+        void releaseMesh();
+        // Bit f set = the boundary layer across face f is fully opaque at the chunk's LOD
+        uint8_t getSolidFaces() const;
+        uint8_t getLod() const { return m_Lod; }
+        // Changing the LOD marks every direction dirty. Neighbors at another LOD
+        // are meshed against as air, so the seam gets faces from both sides
+        void setLod(uint8_t lod);
+        // Meshes uploaded so far, the first one plus every remesh
+        uint32_t getMeshCount() const { return m_MeshCount; }
+        // True if neighbor, across face, covers any of this chunk's boundary faces,
+        // i.e. its arrival changes what the face direction should mesh
+        bool isBorderHiddenBy(const Chunk& neighbor, int face) const;
         void remeshFaceTowardsNeighbor(int faceIndex); 
         void markFaceDirty(int faceIndex);
         void markAllFacesDirty();
-        void draw() const;
+        // Face directions that can point at a camera at cameraPos from somewhere in the chunk's AABB
+        uint8_t getFacesTowards(const glm::vec3& cameraPos) const;
+        // Only the face directions in faceMask are submitted. The mesh is placed
+        // relative to cameraPos through the transform uniform at transformLocation
+        void draw(GLint transformLocation, const glm::vec3& cameraPos, uint8_t faceMask = kAllFaces) const;
+        StorageMode getStorageMode() const;
+        // Opaque occupancy, kept up to date by setBlock. Cheaper than getBlock
+        // for visibility/emptiness tests since it never branches on the storage mode.
+        inline bool isOpaque(int x, int y, int z) const {
+            int bit = opaqueBit(x, y, z);
+            return (m_OpaqueMask[bit >> 6] >> (bit & 63)) & 1;
+        }
+        // Bit x set = voxel (x, y, z) is opaque, for x in [0, kChunkWidth)
+        inline uint64_t getOpaqueRow(int y, int z) const {
+            int bit = opaqueBit(0, y, z);
+            return (m_OpaqueMask[bit >> 6] >> (bit & 63)) & kRowBits;
+        }
+        // Raw mask, kChunkWidth bits per (y, z) row in x-z-y order
+        const std::array<uint64_t, kOpaqueMaskWords>& getOpaqueMask() const;
+        // Takes brick coordinates (voxel coords / kBrickSize). Derived from the opaque
+        // mask on each call, so it is always as current as setBlock left the chunk
+        BrickState getBrickState(int bx, int by, int bz) const;
+        // Initial storage mode for a chunk that will hold solidBlocks non-air blocks
+        static StorageMode storageModeForFill(int solidBlocks);
+        // Mesher used by every chunk's next generateMesh call
+        static void setMeshingMode(MeshingMode mode);
+        static MeshingMode getMeshingMode();
 
-        Chunk(World* world, const glm::vec3& position, StorageMode mode = StorageMode::Dense);
+        // fill = the block every voxel starts as. Sparse chunks always start as air
+        Chunk(World* world, const glm::vec3& position, StorageMode mode = StorageMode::Dense,
+              BlockType fill = BlockType::Air);
         ~Chunk();
     private:
         glm::vec3 m_Position; // World pos
-        std::vector<BlockType> m_Blocks;
-        std::vector<std::optional<Block>> m_BlockObjs;
+        BlockBuffer m_Blocks;
         std::unique_ptr<SparseChunkData> m_Sparse;
+        std::unique_ptr<PaletteChunkData> m_Palette;
         std::unique_ptr<Mesh> m_Mesh;
         StorageMode m_Mode;
+        BlockType m_UniformType; // Only used in StorageMode::Uniform
         World* m_World;
-        bool m_OnlyAir = true;
-        uint8_t m_DirtyFaces = 0; // 6-bit mask: 1 = dirty, 0 = clean
+        std::array<uint32_t, BLOCK_TYPE_COUNT> m_TypeCounts{}; // Voxels of each BlockType in the chunk
+        std::array<uint64_t, kOpaqueMaskWords> m_OpaqueMask{};  // 1 bit per voxel, set = opaque block
+        uint32_t m_EditsSinceMigration = 0;
+        FaceMeshes m_FaceMeshes; // CPU side sub-meshes the current mesh was merged from
+        uint8_t m_DirtyFaces = kAllFaces; // 6-bit mask: 1 = dirty, 0 = clean
+        uint32_t m_MeshCount = 0;
+        uint8_t m_Lod = 0;
+
+        inline static MeshingMode s_MeshingMode = MeshingMode::Greedy;
     private:
-        std::optional<Block> getBlockObj(int x, int y, int z) const;
         void determineVisibleFacesInChunk();
+        // Per face, one bit per voxel whose face is exposed (opaque mask layout)
+        using VisibleFaces = std::array<FaceCulling::Mask, 6>;
+        // Copies the blocks and the neighbors' border opacity out for meshing
+        void takeSnapshot(const Neighbors& neighbors, const NeighborLods& neighborLods, uint8_t lod,
+                          ChunkSnapshot& snapshot) const;
+        // Every voxel in storage index order, one bulk decoder per storage mode
+        void decodeBlocks(BlockType* out) const;
+        // MeshCache key: hashes everything the meshers read from the snapshot
+        static uint64_t hashSnapshot(const ChunkSnapshot& snapshot);
+        // Replaces each cell of the snapshot's blocks with its majority block, see FaceCulling::downsample
+        static void downsampleBlocks(ChunkSnapshot& snapshot, int cellSize);
+        // The meshing steps below only see the snapshot
+        static void computeVisibleFaces(const ChunkSnapshot& snapshot, VisibleFaces& visible);
+        // Emit the faces of a single direction
+        static void generateNaiveMesh(MeshPack& pack, const ChunkSnapshot& snapshot, const VisibleFaces& visible, int face);
+        static void generateGreedyMesh(MeshPack& pack, const ChunkSnapshot& snapshot, const VisibleFaces& visible, int face);
+        StorageMode preferredStorageMode() const; // Cheapest mode for the current contents, respecting hysteresis
+        void migrateTo(StorageMode mode); // Re-encodes the blocks in place and frees the old representation
+        inline bool isOnlyAir() const { return m_TypeCounts[static_cast<int>(BlockType::Air)] == kChunkVolume; }
         bool isBlockActive(int x, int y, int z) const; // Helper that returns whether a block at (x,y,z) is a rendered type or air
         bool hasDirtyFaces() const;
 
         inline int index(int x, int y, int z) const {  // Helper to index into the blocks array.
-            return x + kChunkWidth * (z + kChunkDepth * y); // Flatten 3D index into 1D
+            return ChunkLayout::index(x, y, z); // Linear or Morton, see ChunkLayout.hpp
+        }
+
+        inline static constexpr uint64_t kRowBits = (kChunkWidth == 64) ? ~uint64_t(0) : (uint64_t(1) << kChunkWidth) - 1;
+        // Opaque mask bits always use the linear x-z-y order so whole x rows share a word,
+        // whatever layout the block storage uses
+        inline static int opaqueBit(int x, int y, int z) {
+            return ChunkLayout::linearIndex(x, y, z);
         }
 };
 
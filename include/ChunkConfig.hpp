@@ -0,0 +1,35 @@
+#ifndef CHUNK_CONFIG_HPP
+#define CHUNK_CONFIG_HPP
+
+// Chunk dimensions are fixed at compile time so indexing and loop bounds fold
+// to constants. Override through the VOXEL_CHUNK_* CMake cache variables to
+// build and benchmark other sizes, e.g. 32x32x32 or 32x256x32.
+#ifndef VOXEL_CHUNK_WIDTH
+#define VOXEL_CHUNK_WIDTH 16
+#endif
+
+#ifndef VOXEL_CHUNK_HEIGHT
+#define VOXEL_CHUNK_HEIGHT 16
+#endif
+
+#ifndef VOXEL_CHUNK_DEPTH
+#define VOXEL_CHUNK_DEPTH 16
+#endif
+
+namespace ChunkConfig {
+    inline constexpr int kWidth = VOXEL_CHUNK_WIDTH;   // x
+    inline constexpr int kHeight = VOXEL_CHUNK_HEIGHT; // y
+    inline constexpr int kDepth = VOXEL_CHUNK_DEPTH;   // z
+
+    constexpr bool isPowerOfTwo(int value) {
+        return value > 0 && (value & (value - 1)) == 0;
+    }
+
+    static_assert(isPowerOfTwo(kWidth) && isPowerOfTwo(kHeight) && isPowerOfTwo(kDepth),
+                  "Chunk dimensions must be powers of two");
+    // Bitmask code keeps whole x rows inside one 64-bit word
+    static_assert(kWidth >= 8 && kWidth <= 64, "Chunk width must be between 8 and 64");
+    static_assert(kHeight >= 8 && kDepth >= 8, "Chunk height and depth must be at least 8");
+}
+
+#endif // CHUNK_CONFIG_HPP
@@ -0,0 +1,95 @@
+#ifndef CHUNK_LAYOUT_HPP
+#define CHUNK_LAYOUT_HPP
+
+#include "ChunkConfig.hpp"
+
+#include <array>
+#include <cstdint>
+
+#if defined(__BMI2__)
+#include <immintrin.h>
+#endif
+
+// Voxel ordering used by chunk block storage (dense, palette and sparse).
+// Linear is x-z-y rows. Morton (Z-order) interleaves the coordinate bits so
+// the six face neighbors of a voxel mostly land in the same or an adjacent
+// cache line. Select with the VOXEL_CHUNK_MORTON CMake option.
+#ifndef VOXEL_CHUNK_MORTON
+#define VOXEL_CHUNK_MORTON 0
+#endif
+
+namespace ChunkLayout {
+    inline constexpr bool kMorton = VOXEL_CHUNK_MORTON != 0;
+
+    constexpr int log2(int value) {
+        int bits = 0;
+        while ((1 << bits) < value) bits++;
+        return bits;
+    }
+
+    // Morton bit positions of each axis. Bits are handed out x, z, y per level
+    // until an axis runs out, so non-cubic chunks keep their extra bits on top.
+    struct MortonMasks {
+        uint32_t x = 0, y = 0, z = 0;
+    };
+
+    constexpr MortonMasks makeMortonMasks() {
+        MortonMasks masks;
+        int xBits = log2(ChunkConfig::kWidth);
+        int yBits = log2(ChunkConfig::kHeight);
+        int zBits = log2(ChunkConfig::kDepth);
+
+        int out = 0;
+        for (int level = 0; level < 32; level++) {
+            if (level < xBits) masks.x |= uint32_t(1) << out++;
+            if (level < zBits) masks.z |= uint32_t(1) << out++;
+            if (level < yBits) masks.y |= uint32_t(1) << out++;
+        }
+        return masks;
+    }
+
+    inline constexpr MortonMasks kMortonMasks = makeMortonMasks();
+
+    // Software pdep: scatter the low bits of value into the set bits of mask
+    constexpr uint32_t spreadBits(uint32_t value, uint32_t mask) {
+        uint32_t result = 0;
+        for (int bit = 0; bit < 32; bit++) {
+            if (!(mask & (uint32_t(1) << bit))) continue;
+            if (value & 1) result |= uint32_t(1) << bit;
+            value >>= 1;
+        }
+        return result;
+    }
+
+    template<int N>
+    constexpr std::array<uint32_t, N> makeSpreadTable(uint32_t mask) {
+        std::array<uint32_t, N> table{};
+        for (int i = 0; i < N; i++) table[i] = spreadBits(i, mask);
+        return table;
+    }
+
+    inline constexpr auto kSpreadX = makeSpreadTable<ChunkConfig::kWidth>(kMortonMasks.x);
+    inline constexpr auto kSpreadY = makeSpreadTable<ChunkConfig::kHeight>(kMortonMasks.y);
+    inline constexpr auto kSpreadZ = makeSpreadTable<ChunkConfig::kDepth>(kMortonMasks.z);
+
+    inline int linearIndex(int x, int y, int z) {
+        return x + ChunkConfig::kWidth * (z + ChunkConfig::kDepth * y);
+    }
+
+    inline int mortonIndex(int x, int y, int z) {
+#if defined(__BMI2__)
+        return static_cast<int>(_pdep_u32(x, kMortonMasks.x) |
+                                _pdep_u32(y, kMortonMasks.y) |
+                                _pdep_u32(z, kMortonMasks.z));
+#else
+        return static_cast<int>(kSpreadX[x] | kSpreadY[y] | kSpreadZ[z]);
+#endif
+    }
+
+    inline int index(int x, int y, int z) {
+        if constexpr (kMorton) return mortonIndex(x, y, z);
+        else return linearIndex(x, y, z);
+    }
+}
+
+#endif // CHUNK_LAYOUT_HPP
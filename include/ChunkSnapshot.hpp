@@ -0,0 +1,34 @@
+#ifndef CHUNK_SNAPSHOT_HPP
+#define CHUNK_SNAPSHOT_HPP
+
+#include "ChunkConfig.hpp"
+#include "ChunkLayout.hpp"
+#include "FaceCulling.hpp"
+#include "BlockType.hpp"
+
+#include <array>
+
+// Everything the mesher reads, copied out of a chunk and the border layers of
+// its six neighbors in one pass (see Chunk::takeSnapshot). Meshing then runs
+// purely on this, so it never looks anything up through the World and the
+// source chunks can be unloaded or edited once the snapshot exists.
+//
+// Face culling works on opacity bits, so the padding around the chunk is kept
+// as the neighbors' border opacity rather than as extra block cells.
+struct ChunkSnapshot {
+    static constexpr int kVolume = ChunkConfig::kWidth * ChunkConfig::kHeight * ChunkConfig::kDepth;
+
+    std::array<BlockType, kVolume> blocks; // Linear x-z-y order, whatever the chunk's storage mode
+    FaceCulling::Mask opaque;
+    // Per face, only the neighbor's layer touching this chunk is set. All zero
+    // (air) when that neighbor isn't loaded or is at another LOD
+    std::array<FaceCulling::Mask, 6> neighborBorders;
+    bool uniform = false; // Every block is the same type, only the outer shell can show
+    uint8_t lod = 0;      // blocks and opaque are already downsampled to this LOD
+
+    inline BlockType getBlock(int x, int y, int z) const {
+        return blocks[ChunkLayout::linearIndex(x, y, z)];
+    }
+};
+
+#endif // CHUNK_SNAPSHOT_HPP
@@ -0,0 +1,42 @@
+#ifndef FACE_CULLING_HPP
+#define FACE_CULLING_HPP
+
+#include "ChunkConfig.hpp"
+
+#include <array>
+#include <cstdint>
+
+// Face visibility for a whole chunk computed on occupancy bitmasks.
+// Masks use the chunk's opaque mask layout: kWidth bits per (y, z) row in
+// x-z-y order, so a 64-bit word holds 64 / kWidth rows and every face
+// direction reduces to word shifts, ANDs and NOTs over the mask.
+namespace FaceCulling {
+    inline constexpr int kWords = ChunkConfig::kWidth * ChunkConfig::kHeight * ChunkConfig::kDepth / 64;
+
+    using Mask = std::array<uint64_t, kWords>;
+
+    // visible[face] gets a bit per voxel that is solid and whose neighbor across
+    // face (Chunk::neighborOffsets order) is not opaque.
+    // neighbors[face] is the opaque mask of the chunk across that face, nullptr
+    // when it isn't loaded, which counts as air.
+    void computeVisibleFaces(const Mask& solid, const Mask& opaque,
+                             const std::array<const Mask*, 6>& neighbors,
+                             std::array<Mask, 6>& visible);
+
+    // Copies the layer of neighbor that touches a chunk across face into border
+    // and clears the rest. That layer is all computeVisibleFaces reads from it.
+    void copyBorder(const Mask& neighbor, int face, Mask& border);
+
+    // True if a solid voxel on the boundary layer across face has an opaque
+    // voxel of neighbor against it, i.e. loading neighbor hides some face
+    bool bordersTouch(const Mask& solid, const Mask& neighbor, int face);
+
+    // Coarsens mask to cellSize^3 cells: every voxel of a cell is set when at
+    // least half of the cell is. Used for LOD meshing (see Chunk::setLod)
+    void downsample(const Mask& mask, int cellSize, Mask& out);
+
+    // True if every voxel of mask's boundary layer across face is set
+    bool isBorderFull(const Mask& mask, int face);
+}
+
+#endif // FACE_CULLING_HPP
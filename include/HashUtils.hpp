@@ -2,7 +2,28 @@
 #define HASHUTILS_HPP
 
 #include <glm/glm.hpp>
+#include <cstdint>
+#include <cstring>
 #include <functional>
+
+// 64-bit hash of raw memory, mixed 8 bytes at a time. Good enough for content
+// keys (see MeshCache), not meant to resist crafted collisions
+inline uint64_t hashBytes(const void* data, size_t size, uint64_t seed = 0) {
+    constexpr uint64_t kMul = 0x9E3779B97F4A7C15ull;
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    uint64_t h = seed ^ (size * kMul);
+    for (size_t i = 0; i < size; i += 8) {
+        uint64_t word = 0;
+        std::memcpy(&word, bytes + i, size - i < 8 ? size - i : 8);
+        h = (h ^ word) * kMul;
+        h ^= h >> 32;
+    }
+    h ^= h >> 29;
+    h *= 0xBF58476D1CE4E5B9ull;
+    h ^= h >> 32;
+    return h;
+}
+
 namespace std {
     template<>
     struct hash<glm::ivec3> {
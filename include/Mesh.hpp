@@ -7,14 +7,20 @@
 struct Mesh {
     public:
         void draw() const;
+        // Draws only the face directions set in faceMask (bit = Chunk::neighborOffsets
+        // index), from the pack's faceStarts ranges, in a single draw call
+        void draw(uint8_t faceMask) const;
         void setupMesh();
 
         Mesh(const MeshPack& pack);
+        Mesh(MeshPack&& pack);
         ~Mesh();
 
     private:
         unsigned int m_VAO, m_VBO, m_EBO;
-        MeshPack m_MeshPack;
+        unsigned int m_IndexCount = 0;
+        std::array<unsigned int, 7> m_FaceStarts{};
+        MeshPack m_MeshPack; // Released once setupMesh has uploaded it
 };
 
 #endif // MESH_HPP
@@ -0,0 +1,65 @@
+#ifndef MESH_CACHE_HPP
+#define MESH_CACHE_HPP
+
+#include "MeshPack.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+// Bounded LRU of finished chunk meshes keyed by a hash of everything meshing
+// reads: the chunk's blocks, LOD and the neighbors' border opacity (see
+// Chunk::hashSnapshot). Chunks that are unloaded and generated again come
+// back with the same key, so their mesh is reused instead of rebuilt.
+// Entries share their immutable sub-meshes with the chunks using them.
+class MeshCache {
+    public:
+        using FaceMeshes = std::array<std::shared_ptr<const MeshPack>, 6>;
+
+        struct Stats {
+            uint64_t hits;
+            uint64_t misses;
+            uint64_t evictions;
+            size_t entries;
+            size_t bytes; // Vertex and index data held by the entries
+        };
+
+        inline static constexpr size_t kMaxBytes = 64 * 1024 * 1024;
+    public:
+        // Singleton, shared by every mesh job
+        static MeshCache& instance() {
+            static MeshCache cache(kMaxBytes);
+            return cache;
+        }
+
+        // Fills faces and returns true if key is cached
+        bool find(uint64_t key, FaceMeshes& faces);
+        void insert(uint64_t key, const FaceMeshes& faces);
+        Stats getStats() const;
+
+        explicit MeshCache(size_t maxBytes);
+
+        MeshCache(const MeshCache&) = delete;
+        MeshCache& operator=(const MeshCache&) = delete;
+    private:
+        struct Entry {
+            uint64_t key;
+            FaceMeshes faces;
+            size_t bytes;
+        };
+
+        size_t m_MaxBytes;
+        std::list<Entry> m_Entries; // Most recently used first
+        std::unordered_map<uint64_t, std::list<Entry>::iterator> m_Index;
+        size_t m_Bytes = 0;
+        uint64_t m_Hits = 0;
+        uint64_t m_Misses = 0;
+        uint64_t m_Evictions = 0;
+        mutable std::mutex m_Mutex;
+};
+
+#endif // MESH_CACHE_HPP
@@ -1,11 +1,36 @@
 #ifndef MESHPACK_HPP
 #define MESHPACK_HPP
 
+#include <array>
+#include <cstdint>
 #include <vector>
 
+// 8-byte chunk mesh vertex, decoded in vertex.glsl.
+// x, y, z is the quad corner relative to the chunk origin, shifted by +0.5 on
+// x and z so block corners land on whole numbers. Texture coordinates are
+// derived from the corner and face on the GPU, so a greedy quad still repeats
+// its tile once per block.
+struct PackedVertex {
+    uint16_t x, y, z;
+    uint16_t faceTile; // bits 0-2 face (Chunk::neighborOffsets order), bits 3-10 atlas tile (tileX + tileY * 16)
+
+    static constexpr int kFaceBits = 3;
+
+    PackedVertex() = default;
+    PackedVertex(int cornerX, int cornerY, int cornerZ, int face, int tileIndex)
+        : x(static_cast<uint16_t>(cornerX)),
+          y(static_cast<uint16_t>(cornerY)),
+          z(static_cast<uint16_t>(cornerZ)),
+          faceTile(static_cast<uint16_t>(face | (tileIndex << kFaceBits))) {}
+};
+static_assert(sizeof(PackedVertex) == 8, "PackedVertex must stay tightly packed");
+
 typedef struct MeshPack {
-    std::vector<float> vertices;
+    std::vector<PackedVertex> vertices;
     std::vector<unsigned int> indices;
+    // When indices are grouped by face direction: first index of each direction,
+    // faceStarts[6] is the end. Lets Mesh::draw skip directions
+    std::array<unsigned int, 7> faceStarts{};
 } MeshPack;
 
 #endif // MESHPACK_HPP
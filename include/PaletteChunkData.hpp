@@ -0,0 +1,56 @@
+#ifndef PALETTE_CHUNK_DATA_HPP
+#define PALETTE_CHUNK_DATA_HPP
+
+#include "BlockType.hpp"
+#include "SlabPool.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Per-chunk palette of distinct block types plus bit-packed indices into it.
+// Indices start at 1 bit and widen (1 -> 2 -> 4 -> 8) as the palette grows,
+// so a stone/air chunk costs 512 bytes instead of one byte per voxel.
+struct PaletteChunkData : public PooledObject<PaletteChunkData> {
+    public:
+        inline static constexpr const char* kPoolName = "PaletteChunkData";
+    public:
+        void setBlock(int index, BlockType type);
+        inline BlockType getBlock(int index) const {
+            return m_Palette[readEntry(index)];
+        }
+
+        // Writes every voxel to out in index order. Dispatches on the entry width
+        // once, so the unpacking loop has constant shifts and no branches
+        void decode(BlockType* out) const;
+
+        // volume = number of voxels, every voxel starts as fill
+        PaletteChunkData(int volume, BlockType fill = BlockType::Air);
+
+    private:
+        std::vector<BlockType, PoolAllocator<BlockType>> m_Palette;
+        std::vector<uint32_t, PoolAllocator<uint32_t>> m_RefCounts; // voxels referencing each palette entry, 0 = reusable slot
+        std::vector<uint64_t, PoolAllocator<uint64_t>> m_Data;      // packed palette indices, never straddle a word
+        int m_Volume;
+        int m_BitsPerEntry = 1;
+    private:
+        uint32_t findOrAddEntry(BlockType type);
+        void widen(); // Doubles m_BitsPerEntry and repacks m_Data
+        template <int kBits>
+        void decodeEntries(BlockType* out) const;
+
+        inline uint32_t readEntry(int index) const {
+            int bit = index * m_BitsPerEntry;
+            uint64_t mask = (uint64_t(1) << m_BitsPerEntry) - 1;
+            return static_cast<uint32_t>((m_Data[bit >> 6] >> (bit & 63)) & mask);
+        }
+
+        inline void writeEntry(int index, uint32_t entry) {
+            int bit = index * m_BitsPerEntry;
+            uint64_t mask = (uint64_t(1) << m_BitsPerEntry) - 1;
+            uint64_t& word = m_Data[bit >> 6];
+            word = (word & ~(mask << (bit & 63))) | (uint64_t(entry) << (bit & 63));
+        }
+};
+
+#endif
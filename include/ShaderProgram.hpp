@@ -11,6 +11,8 @@ class ShaderProgram {
         void setUniform(const std::string& name, const glm::mat4& matrix);
         void setUniform(const std::string& name, const glm::vec4& value);
         GLuint getProgram() const;
+        // For uniforms set many times per frame, look the location up once and set it with glUniform*
+        GLint getUniformLocation(const std::string& name) const;
 
         // vertex & fragment path are file paths to shader files
         ShaderProgram(const std::string& vertexPath, const std::string& fragmentPath);
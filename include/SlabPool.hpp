@@ -0,0 +1,107 @@
+#ifndef SLAB_POOL_HPP
+#define SLAB_POOL_HPP
+
+#include <cassert>
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+// Fixed-size block allocator. Blocks are carved out of large slabs and recycled
+// through a free list, so steady-state chunk streaming never touches the heap.
+// Slabs are only released when the pool itself is destroyed.
+class SlabPool {
+    public:
+        struct Stats {
+            const char* name;
+            size_t blockSize;
+            size_t inUse;     // Blocks currently handed out
+            size_t highWater; // Most blocks ever in use at once
+            size_t capacity;  // Blocks across all slabs
+        };
+
+        inline static constexpr size_t kSlabBytes = 1 << 20;
+    public:
+        void* allocate();
+        void deallocate(void* ptr);
+        Stats getStats() const;
+        // Stats for every live pool, buffer size classes and object pools alike
+        static std::vector<Stats> getAllStats();
+
+        // useMmap = back slabs with anonymous mmap regions instead of the heap
+        SlabPool(const char* name, size_t blockSize, bool useMmap);
+        ~SlabPool();
+
+        SlabPool(const SlabPool&) = delete;
+        SlabPool& operator=(const SlabPool&) = delete;
+    private:
+        struct FreeBlock {
+            FreeBlock* next;
+        };
+
+        const char* m_Name;
+        size_t m_BlockSize;
+        size_t m_BlocksPerSlab;
+        bool m_UseMmap;
+        std::vector<void*> m_Slabs;
+        FreeBlock* m_FreeList = nullptr;
+        size_t m_InUse = 0;
+        size_t m_HighWater = 0;
+        mutable std::mutex m_Mutex;
+    private:
+        void addSlab();
+};
+
+// Power-of-two size classes for the variable sized chunk buffers
+// (dense block arrays, packed palette words, sparse masks and values)
+namespace ChunkMemory {
+    inline constexpr size_t kMinBufferSize = 64;
+    inline constexpr size_t kMaxBufferSize = 256 * 1024; // Larger requests fall back to the heap
+
+    void* allocateBuffer(size_t bytes);
+    void deallocateBuffer(void* ptr, size_t bytes);
+    SlabPool& objectPool(const char* name, size_t size);
+}
+
+// std::allocator replacement routing container storage into the chunk buffer pools
+template<typename T>
+struct PoolAllocator {
+    using value_type = T;
+
+    T* allocate(size_t n) {
+        return static_cast<T*>(ChunkMemory::allocateBuffer(n * sizeof(T)));
+    }
+
+    void deallocate(T* ptr, size_t n) {
+        ChunkMemory::deallocateBuffer(ptr, n * sizeof(T));
+    }
+
+    PoolAllocator() = default;
+    template<typename U>
+    PoolAllocator(const PoolAllocator<U>&) {}
+};
+
+template<typename T, typename U>
+bool operator==(const PoolAllocator<T>&, const PoolAllocator<U>&) { return true; }
+template<typename T, typename U>
+bool operator!=(const PoolAllocator<T>&, const PoolAllocator<U>&) { return false; }
+
+// Inherit to have `new T` / `delete` served from a dedicated slab pool.
+// T must declare a `static constexpr const char* kPoolName`.
+template<typename T>
+struct PooledObject {
+    static void* operator new(size_t size) {
+        assert(size == sizeof(T));
+        return pool().allocate();
+    }
+
+    static void operator delete(void* ptr) {
+        if (ptr) pool().deallocate(ptr);
+    }
+
+    static SlabPool& pool() {
+        static SlabPool& p = ChunkMemory::objectPool(T::kPoolName, sizeof(T));
+        return p;
+    }
+};
+
+#endif // SLAB_POOL_HPP
@@ -2,18 +2,42 @@
 #define SPARCE_CHUNK_DATA_HPP
 
 #include "BlockType.hpp"
-#include "HashUtils.hpp"
+#include "BitUtils.hpp"
+#include "SlabPool.hpp"
 
-#include <glm/glm.hpp>
-#include <unordered_map>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
 
-struct SparseChunkData {
+// Occupancy bitmask with one bit per voxel plus a packed array holding only
+// the non-air blocks, ordered by voxel index. A voxel's slot in the array is
+// the number of set bits before it (rank), found with one popcount.
+struct SparseChunkData : public PooledObject<SparseChunkData> {
     public:
-        void setBlock(int x, int y, int z, BlockType type);
-        BlockType getBlock(int x, int y, int z) const;
+        inline static constexpr const char* kPoolName = "SparseChunkData";
+    public:
+        void setBlock(int index, BlockType type);
+        inline BlockType getBlock(int index) const {
+            uint64_t bit = uint64_t(1) << (index & 63);
+            if (!(m_Mask[index >> 6] & bit)) return BlockType::Air;
+            return m_Values[rank(index)];
+        }
+
+        // Writes every voxel to out in index order by walking the set bits, no
+        // per-voxel rank. out holds the whole volume (a multiple of 64)
+        void decode(BlockType* out) const;
 
+        // volume = number of voxels, every voxel starts as air
+        SparseChunkData(int volume);
+
+    private:
+        std::vector<uint64_t, PoolAllocator<uint64_t>> m_Mask;       // 1 = non-air voxel
+        std::vector<uint32_t, PoolAllocator<uint32_t>> m_WordRanks;  // Set bits in all mask words before this one
+        std::vector<BlockType, PoolAllocator<BlockType>> m_Values;   // Non-air blocks in voxel index order
     private:
-        std::unordered_map<glm::ivec3, BlockType> m_Blocks;
+        inline int rank(int index) const {
+            return m_WordRanks[index >> 6] + popcount64(m_Mask[index >> 6] & lowBitsMask(index & 63));
+        }
 };
 
 #endif
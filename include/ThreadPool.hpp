@@ -1,6 +1,7 @@
 #ifndef THREAD_POOL_HPP
 #define THREAD_POOL_HPP
 
+#include <algorithm>
 #include <condition_variable>
 #include <functional>
 #include <mutex>
@@ -44,9 +45,9 @@ private:
     bool stop_ = false;
 private:
     // // Constructor to creates a thread pool with given
-    // number of threads
+    // number of threads. At least one, chunk meshing only runs on the pool
     inline ThreadPool(size_t num_threads
-               = thread::hardware_concurrency() / 2)
+               = std::max(1u, thread::hardware_concurrency() / 2))
     {
 
         // Creating worker threads
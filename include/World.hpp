@@ -5,18 +5,34 @@
 #include "HashUtils.hpp"
 #include "Player.hpp"
 #include "Chunk.hpp"
+#include "ShaderProgram.hpp"
 #include "Utils.hpp"
 
+#include <algorithm>
 #include <unordered_map>
 #include <unordered_set>
+#include <atomic>
+#include <condition_variable>
 #include <cstdint>
 #include <memory>
+#include <chrono>
+#include <deque>
 #include <queue>
 #include <mutex>
 
 class World {
     public:
-        static constexpr int VIEW_DISTANCE = 12; // Chunk units
+        static constexpr int VIEW_DISTANCE = 12; // In 16^3 chunk units
+        // VIEW_DISTANCE per axis in chunks of the configured size, so the loaded
+        // area covers the same blocks whatever the chunk dimensions are
+        static constexpr glm::ivec3 VIEW_EXTENT = {
+            std::max(1, VIEW_DISTANCE * 16 / Chunk::kChunkWidth),
+            std::max(1, VIEW_DISTANCE * 16 / Chunk::kChunkHeight),
+            std::max(1, VIEW_DISTANCE * 16 / Chunk::kChunkDepth)
+        };
+        // Chunks farther than LOD_DISTANCES[i] (same 16^3 units as VIEW_DISTANCE)
+        // are meshed at LOD i + 1, from 2^(i + 1) downsampled blocks
+        static constexpr std::array<int, Chunk::kMaxLod> LOD_DISTANCES = {4, 7, 10};
     public:
         // Takes in an ivec3 world position and returns the type of block that is present
         BlockType getBlockAtWorld(const glm::ivec3& worldPos) const;
@@ -33,10 +49,15 @@ class World {
         void queueChunkForRemeshing(const glm::ivec3& pos);
         // update is called each frame
         void update(float dt);
-        void draw();
+        void draw(ShaderProgram& shader);
+        // Average CPU time of Chunk::buildMesh since startup, used to compare build configurations
+        double getAverageMeshMicros() const;
+        // Uploaded meshes per chunk load, 1.0 means no loaded chunk was remeshed.
+        // Dropped stale jobs don't count, a chunk unloaded and generated again counts as a new load
+        double getAverageMeshesPerChunk() const;
 
         World(uint64_t seed);
-        ~World() = default;
+        ~World();
     private:
         uint64_t m_Seed;
         ChunkGenerator m_ChunkGenerator;
@@ -51,11 +72,51 @@ class World {
         mutable std::mutex m_MeshQueueMutex;
         std::unordered_set<glm::ivec3> m_MeshQueuedChunks; // prevent duplicates in the mesh queue
 
-        std::unordered_map<glm::ivec3, std::unique_ptr<Chunk>> m_Chunks; // Current chunks loaded in memory
+        // New chunks wait here for their first mesh until every neighbor is
+        // resolved (loaded, known air or out of view) or the deadline passes,
+        // so they are not meshed against missing neighbors and then remeshed
+        static constexpr std::chrono::milliseconds MESH_NEIGHBOR_DEADLINE{500};
+        std::unordered_map<glm::ivec3, std::chrono::steady_clock::time_point> m_PendingFirstMesh;
+
+        // Finished CPU mesh waiting for its GL upload on the main thread
+        struct MeshUpload {
+            glm::ivec3 pos;
+            std::shared_ptr<Chunk> chunk;
+            // Held until the upload so chunks (and their GL buffers) are only ever freed on the main thread
+            std::array<std::shared_ptr<const Chunk>, 6> neighbors;
+            uint64_t ticket;
+            Chunk::MeshBuild build;
+            double micros; // CPU meshing time
+        };
+        // A job counts against MAX_MESH_JOBS_IN_FLIGHT until its result leaves the
+        // upload queue, so the queue never holds more than that many results
+        static constexpr int MAX_MESH_JOBS_IN_FLIGHT = 32;
+        static constexpr int MAX_MESH_UPLOADS_PER_FRAME = 8; // Stale results don't count
+        std::deque<MeshUpload> m_UploadQueue; // Filled by mesh jobs, drained in update
+        std::mutex m_UploadQueueMutex;
+        int m_MeshJobsOutstanding = 0; // Dispatched, result not taken off m_UploadQueue yet. Main thread only
+        std::atomic<int> m_MeshJobsInFlight{0}; // Jobs still running on the ThreadPool
+        std::mutex m_MeshJobsMutex;
+        std::condition_variable m_MeshJobsDone; // Signalled as jobs finish, ~World waits on it
+        uint64_t m_NextMeshTicket = 0;
+        std::unordered_map<glm::ivec3, uint64_t> m_LatestMeshTicket; // Newest job per chunk, older results are dropped
+
+        // Current chunks loaded in memory. Shared so in-flight mesh jobs keep
+        // their chunk and its neighbors alive if they get unloaded meanwhile
+        std::unordered_map<glm::ivec3, std::shared_ptr<Chunk>> m_Chunks;
         mutable std::mutex m_ChunkMutex;
-        std::vector<glm::ivec3> m_AirChunks; // List the chunks found containing only air so we don't try to re-load them
+        // Chunks enclosed by fully opaque neighbor faces. They have no mesh and
+        // are skipped until one of their neighbors is remeshed
+        std::unordered_set<glm::ivec3> m_OccludedChunks;
+        std::unordered_set<glm::ivec3> m_AirChunks; // Chunks found containing only air so we don't try to re-load them
         constexpr static float UNLOAD_INTERVAL = 0.5f; // Interval for unloading outdated chunks in the update loop
         float m_UnloadTimer = 0.0f;
+        constexpr static float STATS_INTERVAL = 1.0f; // Seconds between chunk and meshing stats on stdout
+        float m_StatsTimer = 0.0f;
+        uint64_t m_MeshedChunks = 0; // Finished mesh jobs, including dropped ones
+        uint64_t m_FirstMeshes = 0;  // Chunks that got their first mesh uploaded
+        uint64_t m_Remeshes = 0;     // Uploads that replaced an earlier mesh
+        double m_MeshMicrosTotal = 0.0;
     private:
         glm::ivec3 worldToChunkCoords(const glm::vec3& position) const;
         bool isChunkInView(const glm::ivec3& playerChunk, const glm::ivec3& chunkCoords) const;
@@ -63,6 +124,15 @@ class World {
         void unloadOutdatedChunks(const glm::ivec3& playerChunkPos);
         void enqueueNearbyChunks(const glm::ivec3& playerChunkPos);
         void sortMeshingQueue(const glm::ivec3& playerChunkPos);
+        uint8_t lodForChunk(const glm::ivec3& playerChunkPos, const glm::ivec3& chunkCoord) const;
+        void updateChunkLods(const glm::ivec3& playerChunkPos); // Re-rings loaded chunks after the player moved
+        bool isChunkBuried(const glm::ivec3& chunkCoord) const; // Every neighbor face against it is fully opaque
+        void pushMeshQueue(const glm::ivec3& pos);
+        bool isChunkResolved(const glm::ivec3& playerChunkPos, const glm::ivec3& chunkCoord) const;
+        void queueReadyFirstMeshes(const glm::ivec3& playerChunkPos); // Moves pending chunks to the mesh queue
+        void dispatchMeshJobs(); // Hands queued chunks to the ThreadPool for CPU meshing
+        void uploadFinishedMeshes(); // GL upload of finished jobs, bounded per frame
+        void printStats() const;
 };
 
 #endif // WORLD_HPP
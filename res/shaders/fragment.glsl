@@ -1,10 +1,22 @@
 #version 330 core
 out vec4 FragColor;
 
-in vec2 TexCoord;
+in vec2 TexCoord; // One unit per block along the face
+flat in vec2 Tile;  // Atlas tile (column, row)
 
 uniform sampler2D textureAtlas;
 
+// 16 x 16 tile texture atlas
+const float TILE_SIZE = 1.0 / 16.0;
+
 void main() {
-    FragColor = texture(textureAtlas, TexCoord);
+    // Wrap so a merged quad repeats its tile once per block. v is flipped to
+    // match the atlas rows (see stbi_set_flip_vertically_on_load in loadTexture)
+    vec2 local = fract(TexCoord);
+    vec2 atlasCoord = (Tile + vec2(local.x, 1.0 - local.y)) * TILE_SIZE;
+
+    // Take gradients from the unwrapped coordinates, otherwise the jump at each
+    // block edge selects the smallest mip level and draws seams
+    vec2 grad = TexCoord * TILE_SIZE;
+    FragColor = textureGrad(textureAtlas, atlasCoord, dFdx(grad), dFdy(grad));
 }
@@ -1,16 +1,30 @@
 #version 330 core
-layout (location = 0) in vec3 aPos;
-layout (location = 1) in vec2 aTexCoord;
+// x, y, z: quad corner relative to the chunk origin, +0.5 on x and z
+// w: bits 0-2 face, bits 3-10 atlas tile (column + row * 16)
+layout (location = 0) in uvec4 aPacked;
 
-// Uniforms for transformation matrices
+// Uniforms for transformation matrices. transform places the chunk relative
+// to the camera and view only rotates, so positions stay small far from the origin
 uniform mat4 transform;
 uniform mat4 view;
 uniform mat4 projection;
 
 out vec2 TexCoord;
+flat out vec2 Tile;
+
+// Axes the texture's u and v run along for each face (-z, +z, -x, +x, -y, +y), see faceAxes in Block.hpp
+const int U_AXIS[6] = int[6](0, 0, 2, 2, 0, 0);
+const int V_AXIS[6] = int[6](1, 1, 1, 1, 2, 2);
 
 void main() {
-    gl_Position = projection * view * transform * vec4(aPos, 1.0);
-    TexCoord = aTexCoord;
-}
+    vec3 corner = vec3(aPacked.xyz);
+    int face = int(aPacked.w & 7u);
+    int tile = int(aPacked.w >> 3u);
 
+    vec3 position = corner - vec3(0.5, 0.0, 0.5);
+    gl_Position = projection * view * transform * vec4(position, 1.0);
+
+    // Corners sit on block boundaries, so the fragment shader's fract() wraps once per block
+    TexCoord = vec2(corner[U_AXIS[face]], corner[V_AXIS[face]]);
+    Tile = vec2(tile % 16, tile / 16);
+}
@@ -118,16 +118,16 @@ void Application::render(float deltaTime) {
     Camera* cam = m_World->getPlayer()->getCamera();
     float aspect = static_cast<float>(m_Window.getSize().x) / m_Window.getSize().y;
     glm::mat4 projection = cam->getProjectionMatrix(aspect);
-    glm::mat4 view = cam->getViewMatrix();
+    // Chunks are drawn relative to the camera, World::draw sets each one's transform
+    glm::mat4 view = cam->getRotationViewMatrix();
 
     m_ShaderProgram->setUniform("projection", projection);
     m_ShaderProgram->setUniform("view", view);
-    m_ShaderProgram->setUniform("transform", glm::mat4(1.0f));
 
     glActiveTexture(GL_TEXTURE0);
     glBindTexture(GL_TEXTURE_2D, m_TextureAtlas);
 
-    m_World->draw();
+    m_World->draw(*m_ShaderProgram);
 
     updateOverlay(deltaTime);
 
@@ -1,253 +1,651 @@
 #include "Chunk.hpp"
 #include "World.hpp"
+#include "BitUtils.hpp"
+#include "HashUtils.hpp"
+#include "MeshCache.hpp"
+#include <glm/gtc/matrix_transform.hpp>
 #include <iostream>
+#include <algorithm>
 
-Chunk::Chunk(World* world, const glm::vec3& pos, StorageMode mode)
+Chunk::Chunk(World* world, const glm::vec3& pos, StorageMode mode, BlockType fill)
     : m_World(world),
     m_Position(pos),
-    m_Blocks((kChunkWidth * kChunkHeight * kChunkDepth), BlockType::Air), // default everything to BlockType::Air
-    m_BlockObjs((kChunkWidth * kChunkHeight * kChunkDepth)), // default everything with std::optional
-    m_Mode(mode) {
+    m_Mode(mode),
+    m_UniformType(fill) {
+        m_TypeCounts[static_cast<int>(fill)] = kChunkVolume;
+        if (Block::getInfo(fill).opaque) m_OpaqueMask.fill(~uint64_t(0));
         std::cout << "Creating chunk @ pos: " << pos.x << ", " << pos.y << "," << pos.z << std::endl;
-        if (m_Mode == StorageMode::Dense) {
-            m_Blocks.resize(kChunkDepth * kChunkDepth * kChunkHeight, BlockType::Air);
-        } else {
-            m_Sparse = std::make_unique<SparseChunkData>();
+        switch (m_Mode) {
+            case StorageMode::Dense:
+                m_Blocks.resize(kChunkVolume, fill);
+                break;
+            case StorageMode::Sparse:
+                assert(fill == BlockType::Air);
+                m_Sparse = std::make_unique<SparseChunkData>(kChunkVolume);
+                break;
+            case StorageMode::Palette:
+                m_Palette = std::make_unique<PaletteChunkData>(kChunkVolume, fill);
+                break;
+            case StorageMode::Uniform:
+                break;
         }
     }
 
 Chunk::~Chunk() {
     m_Blocks.clear();
-    m_BlockObjs.clear();
     m_Sparse.reset();
+    m_Palette.reset();
     m_Mesh.reset();
 }
 
 void Chunk::setBlock(int x, int y, int z, BlockType type) {
-    if (m_Mode == StorageMode::Dense) {
-        m_Blocks[index(x,y,z)] = type;
-    } else {
-        m_Sparse->setBlock(x, y, z, type);
+    assert(static_cast<int>(type) < BLOCK_TYPE_COUNT);
+
+    BlockType old = getBlock(x, y, z);
+    if (old == type) return;
+
+    // A uniform chunk has nowhere to store a differing block, promote it first
+    if (m_Mode == StorageMode::Uniform) {
+        migrateTo(StorageMode::Palette);
+    }
+
+    switch (m_Mode) {
+        case StorageMode::Dense:
+            m_Blocks[index(x,y,z)] = type;
+            break;
+        case StorageMode::Sparse:
+            m_Sparse->setBlock(index(x,y,z), type);
+            break;
+        case StorageMode::Palette:
+            m_Palette->setBlock(index(x,y,z), type);
+            break;
+        case StorageMode::Uniform:
+            break;
+    }
+
+    m_TypeCounts[static_cast<int>(old)]--;
+    m_TypeCounts[static_cast<int>(type)]++;
+
+    const BlockInfo& newInfo = Block::getInfo(type);
+
+    int bit = opaqueBit(x, y, z);
+    if (newInfo.opaque) m_OpaqueMask[bit >> 6] |= uint64_t(1) << (bit & 63);
+    else m_OpaqueMask[bit >> 6] &= ~(uint64_t(1) << (bit & 63));
+
+    // The block's own faces point every way, so every direction needs a rebuild
+    m_DirtyFaces = kAllFaces;
+
+    if (++m_EditsSinceMigration >= kMigrationCooldown) {
+        StorageMode preferred = preferredStorageMode();
+        if (preferred != m_Mode) migrateTo(preferred);
+    }
+}
+
+Chunk::StorageMode Chunk::storageModeForFill(int solidBlocks) {
+    // Midway between the sparse enter/exit thresholds
+    return solidBlocks < (kSparseEnterBlocks + kSparseExitBlocks) / 2
+        ? StorageMode::Sparse
+        : StorageMode::Palette;
+}
+
+Chunk::StorageMode Chunk::preferredStorageMode() const {
+    int distinctTypes = 0;
+    for (uint32_t count : m_TypeCounts) {
+        if (count == kChunkVolume) return StorageMode::Uniform;
+        if (count > 0) distinctTypes++;
+    }
+
+    int solidBlocks = kChunkVolume - m_TypeCounts[static_cast<int>(BlockType::Air)];
+
+    // Sparse stays sparse until it crosses the upper threshold, everything
+    // else only turns sparse once it drops below the lower one
+    bool sparse = (m_Mode == StorageMode::Sparse)
+        ? solidBlocks <= kSparseExitBlocks
+        : solidBlocks < kSparseEnterBlocks;
+    if (sparse) return StorageMode::Sparse;
+
+    // Once a palette needs close to a byte per voxel a plain array is cheaper
+    bool dense = (m_Mode == StorageMode::Dense)
+        ? distinctTypes > kPaletteEnterTypes
+        : distinctTypes > kPaletteExitTypes;
+    return dense ? StorageMode::Dense : StorageMode::Palette;
+}
+
+void Chunk::migrateTo(StorageMode mode) {
+    assert(mode != m_Mode);
+
+    // A uniform chunk's value seeds the new storage, so no voxels need copying
+    bool fromUniform = m_Mode == StorageMode::Uniform;
+    BlockType fill = fromUniform ? m_UniformType : BlockType::Air;
+    assert(!(fromUniform && mode == StorageMode::Sparse && fill != BlockType::Air));
+
+    BlockBuffer dense;
+    std::unique_ptr<SparseChunkData> sparse;
+    std::unique_ptr<PaletteChunkData> palette;
+    BlockType uniformType = m_UniformType;
+
+    switch (mode) {
+        case StorageMode::Dense:
+            dense.assign(kChunkVolume, fill);
+            break;
+        case StorageMode::Sparse:
+            sparse = std::make_unique<SparseChunkData>(kChunkVolume);
+            break;
+        case StorageMode::Palette:
+            palette = std::make_unique<PaletteChunkData>(kChunkVolume, fill);
+            break;
+        case StorageMode::Uniform:
+            uniformType = getBlock(0, 0, 0);
+            break;
     }
 
-    if (type == BlockType::Air) {
-        m_BlockObjs[index(x,y,z)] = std::nullopt;
-        return;
+    if (!fromUniform && mode != StorageMode::Uniform) {
+        // Both representations share the storage index order, so no coordinates needed
+        static thread_local std::array<BlockType, kChunkVolume> blocks;
+        decodeBlocks(blocks.data());
+        for (int i = 0; i < kChunkVolume; ++i) {
+            BlockType type = blocks[i];
+            if (type == BlockType::Air) continue;
+
+            if (mode == StorageMode::Dense) dense[i] = type;
+            else if (mode == StorageMode::Sparse) sparse->setBlock(i, type);
+            else palette->setBlock(i, type);
+        }
     }
 
-    if (m_OnlyAir) m_OnlyAir = false;
+    // Swap in the new representation and release the old buffers entirely
+    m_Blocks.swap(dense);
+    m_Sparse = std::move(sparse);
+    m_Palette = std::move(palette);
+    m_UniformType = uniformType;
+    m_Mode = mode;
+    m_EditsSinceMigration = 0;
+}
+
+void Chunk::setMeshingMode(MeshingMode mode) {
+    s_MeshingMode = mode;
+}
+
+Chunk::MeshingMode Chunk::getMeshingMode() {
+    return s_MeshingMode;
+}
 
-    glm::vec3 worldSpaceCoords = {x + m_Position.x, y + m_Position.y, z + m_Position.z};
-    m_BlockObjs[index(x,y,z)] = Block(type, worldSpaceCoords);
+Chunk::StorageMode Chunk::getStorageMode() const {
+    return m_Mode;
+}
+
+const std::array<uint64_t, Chunk::kOpaqueMaskWords>& Chunk::getOpaqueMask() const {
+    return m_OpaqueMask;
+}
+
+Chunk::BrickState Chunk::getBrickState(int bx, int by, int bz) const {
+    assert(bx >= 0 && bx < kBricksX && by >= 0 && by < kBricksY && bz >= 0 && bz < kBricksZ);
+
+    // The brick's slice of each opaque row
+    const uint64_t brickBits = ((uint64_t(1) << kBrickSize) - 1) << (bx * kBrickSize);
+    bool anyOpaque = false;
+    bool allOpaque = true;
+    for (int y = by * kBrickSize; y < (by + 1) * kBrickSize; ++y) {
+        for (int z = bz * kBrickSize; z < (bz + 1) * kBrickSize; ++z) {
+            uint64_t row = getOpaqueRow(y, z) & brickBits;
+            anyOpaque |= row != 0;
+            allOpaque &= row == brickBits;
+        }
+    }
+
+    if (allOpaque) return BrickState::Full;
+    // Non-opaque rendered blocks are not in the opaque mask, so an opaque-free brick may still draw
+    if constexpr (renderedMatchesOpaque()) {
+        if (!anyOpaque) return BrickState::Empty;
+    }
+    return BrickState::Mixed;
 }
 
 void Chunk::generateMesh() {
-    if (m_OnlyAir) return;
+    markAllFacesDirty();
+    generateDirtyMesh();
+}
 
-    // Clear all face mesh packs
-    /*for (auto& facePack : m_FaceMeshPacks) {
-        facePack.vertices.clear();
-        facePack.indices.clear();
-    }*/
+void Chunk::generateDirtyMesh() {
+    const glm::ivec3 chunkPos = glm::ivec3(m_Position) / glm::ivec3(kChunkWidth, kChunkHeight, kChunkDepth);
+
+    Neighbors neighbors{};
+    NeighborLods neighborLods{};
+    for (int face = 0; face < 6; ++face) {
+        neighbors[face] = m_World->getChunkAtChunkPos(chunkPos + neighborOffsets[face]);
+        if (neighbors[face]) neighborLods[face] = neighbors[face]->getLod();
+    }
+
+    uploadMesh(buildMesh(neighbors, neighborLods, m_Lod, m_DirtyFaces, m_FaceMeshes));
+}
 
+void Chunk::setLod(uint8_t lod) {
+    assert(lod <= kMaxLod);
+    if (lod == m_Lod) return;
+    m_Lod = lod;
+    m_DirtyFaces = kAllFaces;
+}
+
+void Chunk::releaseMesh() {
     m_Mesh.reset();
+    m_FaceMeshes = {};
+    m_DirtyFaces = kAllFaces;
+}
 
-    MeshPack pack;
+uint8_t Chunk::getSolidFaces() const {
+    // Judged on what the chunk draws, a coarse mesh can open holes the blocks don't have
+    FaceCulling::Mask coarse;
+    if (m_Lod > 0) FaceCulling::downsample(m_OpaqueMask, 1 << m_Lod, coarse);
+    const FaceCulling::Mask& drawn = m_Lod > 0 ? coarse : m_OpaqueMask;
 
-    pack.vertices.reserve(kChunkWidth * kChunkHeight * kChunkDepth * 6 * 4 * 5); // Rough upper bound
-    pack.indices.reserve(kChunkWidth * kChunkHeight * kChunkDepth * 6 * 6);
+    uint8_t solidFaces = 0;
+    for (int face = 0; face < 6; ++face) {
+        if (FaceCulling::isBorderFull(drawn, face)) solidFaces |= 1 << face;
+    }
+    return solidFaces;
+}
 
-    for (int y = 0; y < kChunkHeight; ++y) {
-        for (int z = 0; z < kChunkDepth; ++z) {
-            for (int x = 0; x < kChunkWidth; ++x) {
-                BlockType blockType = getBlock(x, y, z);
-                if (blockType == BlockType::Air) continue;
+bool Chunk::isBorderHiddenBy(const Chunk& neighbor, int face) const {
+    // Non-opaque rendered blocks are not in the opaque mask, so assume they could be
+    if constexpr (renderedMatchesOpaque()) {
+        return FaceCulling::bordersTouch(m_OpaqueMask, neighbor.m_OpaqueMask, face);
+    } else {
+        return true;
+    }
+}
 
-                std::optional<Block> b = getBlockObj(x, y, z);
-                if (!b.has_value()) continue;
+void Chunk::uploadMesh(MeshBuild&& build) {
+    m_FaceMeshes = std::move(build.faces);
+    m_DirtyFaces &= ~build.rebuiltFaces;
+    m_MeshCount++;
 
-                std::vector<bool> visible(6, false);
-                for (int face = 0; face < 6; ++face) {
-                    int nx = x + neighborOffsets[face].x;
-                    int ny = y + neighborOffsets[face].y;
-                    int nz = z + neighborOffsets[face].z;
+    m_Mesh.reset();
+    if (!build.merged.indices.empty()) {
+        m_Mesh = std::make_unique<Mesh>(std::move(build.merged));
+        m_Mesh->setupMesh();
+    }
+}
 
-                    bool neighborInRange = (nx >= 0 && ny >= 0 && nz >= 0 &&
-                                            nx < kChunkWidth && ny < kChunkHeight && nz < kChunkDepth);
+Chunk::MeshBuild Chunk::buildMesh(const Neighbors& neighbors, const NeighborLods& neighborLods, uint8_t lod,
+                                  uint8_t dirtyFaces, const FaceMeshes& previous) const {
+    static const std::shared_ptr<const MeshPack> kEmptyFace = std::make_shared<MeshPack>();
 
-                    bool faceVisible = false;
+    MeshBuild build;
+    build.faces = previous;
 
-                    // Neighboring block belongs to another chunk
-                    if (!neighborInRange) {
-                        glm::ivec3 worldPos(
-                                static_cast<int>(m_Position.x) + x + neighborOffsets[face].x,
-                                static_cast<int>(m_Position.y) + y + neighborOffsets[face].y,
-                                static_cast<int>(m_Position.z) + z + neighborOffsets[face].z
-                                );
+    // Directions that were never built have nothing to reuse
+    for (int face = 0; face < 6; ++face) {
+        if (!previous[face]) dirtyFaces |= 1 << face;
+    }
+    build.rebuiltFaces = dirtyFaces;
 
-                        BlockType neighbor = m_World->getBlockAtWorld(worldPos);
+    if (isOnlyAir()) {
+        for (int face = 0; face < 6; ++face) {
+            if (dirtyFaces & (1 << face)) build.faces[face] = kEmptyFace;
+        }
+    } else if (dirtyFaces) {
+        // From here on meshing only reads the snapshot
+        static thread_local ChunkSnapshot snapshot;
+        takeSnapshot(neighbors, neighborLods, lod, snapshot);
+
+        // Full rebuilds of contents meshed before, like a chunk that was
+        // unloaded and generated again, come straight from the cache
+        uint64_t cacheKey = 0;
+        bool cached = false;
+        if (dirtyFaces == kAllFaces) {
+            cacheKey = hashSnapshot(snapshot);
+            cached = MeshCache::instance().find(cacheKey, build.faces);
+        }
 
-                        if (neighbor == BlockType::Air) {
-                            faceVisible = true;
-                        }
-                    } else {
-                        faceVisible = (getBlock(nx, ny, nz) == BlockType::Air);
-                    }
-                    /*if (!neighborInRange) {
-                        glm::ivec3 neighborChunkPos = glm::ivec3(m_Position) + neighborOffsets[face];
-                        // glm::ivec3 chunkPos = glm::floor(m_Position / glm::vec3(kChunkWidth, kChunkHeight, kChunkDepth));
-                        // glm::ivec3 neighborChunkPos = chunkPos + neighborOffsets[face];
-                        Chunk* nChunk = m_World->getChunkAtChunkPos(neighborChunkPos);
-
-                        if (nChunk == nullptr) {
-                            faceVisible = true;
-                        } else {
-                            int localX = (x + neighborOffsets[face].x + kChunkWidth) % kChunkWidth;
-                            if (localX < 0) localX += kChunkWidth;
-                            int localY = (y + neighborOffsets[face].y + kChunkHeight) % kChunkHeight;
-                            if (localY < 0) localX += kChunkHeight;
-                            int localZ = (z + neighborOffsets[face].z + kChunkDepth) % kChunkDepth;
-                            if (localZ < 0) localX += kChunkDepth;
-
-                            faceVisible = nChunk->getBlock(localX, localY, localZ) == BlockType::Air;
-                        }
-                    } else {
-                        faceVisible = getBlock(nx, ny, nz) == BlockType::Air;
-                    }*/
+        if (!cached) {
+            static thread_local VisibleFaces visible;
+            computeVisibleFaces(snapshot, visible);
 
-                    visible[face] = faceVisible;
-                    /*if (faceVisible) {
-                        visible[face] = true;
+            // Build into a per-thread scratch buffer. It keeps its capacity between
+            // directions and chunks, so reserve only grows it at a new high-water mark.
+            static thread_local MeshPack scratch;
 
-                        int baseIndex = m_FaceMeshPacks[face].vertices.size() / 5;
-                        b->defineRenderedFaces(m_FaceMeshPacks[face], visible);
-                    }*/
+            for (int face = 0; face < 6; ++face) {
+                if (!(dirtyFaces & (1 << face))) continue;
+
+                // Exact face count, so the naive mesher never reallocates and greedy stays within it
+                size_t faceCount = 0;
+                for (uint64_t word : visible[face]) faceCount += popcount64(word);
+                if (faceCount == 0) {
+                    build.faces[face] = kEmptyFace;
+                    continue;
                 }
-                b->defineRenderedFaces(pack, visible);
+
+                scratch.vertices.clear();
+                scratch.indices.clear();
+                scratch.vertices.reserve(faceCount * 4);
+                scratch.indices.reserve(faceCount * 6);
+
+                // Coarse cells only save triangles once their faces are merged
+                if (s_MeshingMode == MeshingMode::Greedy || snapshot.lod > 0) {
+                    generateGreedyMesh(scratch, snapshot, visible, face);
+                } else {
+                    generateNaiveMesh(scratch, snapshot, visible, face);
+                }
+
+                // Keep an exact-sized copy, the scratch stays with the thread
+                auto facePack = std::make_shared<MeshPack>();
+                facePack->vertices.assign(scratch.vertices.begin(), scratch.vertices.end());
+                facePack->indices.assign(scratch.indices.begin(), scratch.indices.end());
+                build.faces[face] = std::move(facePack);
             }
+
+            if (dirtyFaces == kAllFaces) MeshCache::instance().insert(cacheKey, build.faces);
         }
     }
 
-    // Merge all face packs into the final mesh
-    /*MeshPack combined;
-    for (const auto& facePack : m_FaceMeshPacks) {
-        int indexOffset = combined.vertices.size() / 5;
-        combined.vertices.insert(combined.vertices.end(), facePack.vertices.begin(), facePack.vertices.end());
+    // Merge the directions in face order, each one a contiguous index range
+    size_t vertexCount = 0;
+    size_t indexCount = 0;
+    for (const auto& facePack : build.faces) {
+        vertexCount += facePack->vertices.size();
+        indexCount += facePack->indices.size();
+    }
 
+    build.merged.vertices.reserve(vertexCount);
+    build.merged.indices.reserve(indexCount);
+    for (int face = 0; face < 6; ++face) {
+        const MeshPack& facePack = *build.faces[face];
+        build.merged.faceStarts[face] = build.merged.indices.size();
+        unsigned int indexOffset = build.merged.vertices.size();
+        build.merged.vertices.insert(build.merged.vertices.end(), facePack.vertices.begin(), facePack.vertices.end());
         for (unsigned int idx : facePack.indices) {
-            combined.indices.push_back(idx + indexOffset);
+            build.merged.indices.push_back(idx + indexOffset);
         }
-    }*/
+    }
+    build.merged.faceStarts[6] = build.merged.indices.size();
 
-    m_Mesh = std::make_unique<Mesh>(pack);
-    m_Mesh->setupMesh();
-    m_DirtyFaces = 0;
+    return build;
 }
 
-void Chunk::remeshFaceTowardsNeighbor(int faceIndex) {
-    assert(faceIndex <= 6 && faceIndex >= 0);
-    markFaceDirty(faceIndex);
+void Chunk::takeSnapshot(const Neighbors& neighbors, const NeighborLods& neighborLods, uint8_t lod,
+                         ChunkSnapshot& snapshot) const {
+    // Decode the blocks into linear order, branching on the storage mode once for the whole chunk
+    if (m_Mode == StorageMode::Uniform) {
+        snapshot.blocks.fill(m_UniformType);
+    } else if constexpr (!ChunkLayout::kMorton) {
+        // Storage order is already linear
+        decodeBlocks(snapshot.blocks.data());
+    } else {
+        static thread_local std::array<BlockType, kChunkVolume> storageOrder;
+        decodeBlocks(storageOrder.data());
+        int i = 0;
+        for (int y = 0; y < kChunkHeight; ++y) {
+            for (int z = 0; z < kChunkDepth; ++z) {
+                for (int x = 0; x < kChunkWidth; ++x) {
+                    snapshot.blocks[i++] = storageOrder[index(x, y, z)];
+                }
+            }
+        }
+    }
+
+    snapshot.uniform = m_Mode == StorageMode::Uniform;
+    snapshot.lod = lod;
+    if (lod == 0) {
+        snapshot.opaque = m_OpaqueMask;
+    } else {
+        // Opacity is downsampled from the mask alone, so the neighbors' coarse
+        // borders below come out exactly as they mesh themselves
+        FaceCulling::downsample(m_OpaqueMask, 1 << lod, snapshot.opaque);
+        if (!snapshot.uniform) downsampleBlocks(snapshot, 1 << lod);
+    }
 
-    // glm::ivec3 chunkCoords = glm::floor(m_Position / glm::vec3(kChunkWidth, kChunkHeight, kChunkDepth));
-    m_World->queueChunkForRemeshing(m_Position);
+    static thread_local FaceCulling::Mask coarseNeighbor;
+    for (int face = 0; face < 6; ++face) {
+        // Across an LOD seam the surfaces don't line up, both sides emit their faces
+        if (!neighbors[face] || neighborLods[face] != lod) {
+            snapshot.neighborBorders[face].fill(0);
+        } else if (lod == 0) {
+            FaceCulling::copyBorder(neighbors[face]->getOpaqueMask(), face, snapshot.neighborBorders[face]);
+        } else {
+            FaceCulling::downsample(neighbors[face]->getOpaqueMask(), 1 << lod, coarseNeighbor);
+            FaceCulling::copyBorder(coarseNeighbor, face, snapshot.neighborBorders[face]);
+        }
+    }
 }
 
-void Chunk::markFaceDirty(int faceIndex) {
-    assert(faceIndex <= 6 && faceIndex >= 0);
-    // m_DirtyFaces = 0b111111;
-    m_DirtyFaces |= (1 << faceIndex);
+void Chunk::decodeBlocks(BlockType* out) const {
+    switch (m_Mode) {
+        case StorageMode::Dense:
+            std::copy(m_Blocks.begin(), m_Blocks.end(), out);
+            break;
+        case StorageMode::Sparse:
+            m_Sparse->decode(out);
+            break;
+        case StorageMode::Palette:
+            m_Palette->decode(out);
+            break;
+        case StorageMode::Uniform:
+            std::fill_n(out, kChunkVolume, m_UniformType);
+            break;
+    }
 }
 
-void Chunk::markAllFacesDirty() {
-    m_DirtyFaces = 0b111111;
-    assert(m_DirtyFaces == 6);
+uint64_t Chunk::hashSnapshot(const ChunkSnapshot& snapshot) {
+    // The opaque mask follows from the blocks, the uniform flag never changes the output
+    uint64_t h = hashBytes(snapshot.blocks.data(), sizeof(snapshot.blocks));
+    h = hashBytes(snapshot.neighborBorders.data(), sizeof(snapshot.neighborBorders), h);
+    const uint8_t settings[2] = {snapshot.lod, static_cast<uint8_t>(s_MeshingMode)};
+    return hashBytes(settings, sizeof(settings), h);
 }
 
-bool Chunk::hasDirtyFaces() const {
-    return m_DirtyFaces != 0;
+void Chunk::downsampleBlocks(ChunkSnapshot& snapshot, int cellSize) {
+    const int cellVolume = cellSize * cellSize * cellSize;
+    std::array<uint16_t, BLOCK_TYPE_COUNT> counts;
+
+    for (int y = 0; y < kChunkHeight; y += cellSize) {
+        for (int z = 0; z < kChunkDepth; z += cellSize) {
+            for (int x = 0; x < kChunkWidth; x += cellSize) {
+                counts.fill(0);
+                int opaqueCount = 0;
+                for (int dy = 0; dy < cellSize; ++dy) {
+                    for (int dz = 0; dz < cellSize; ++dz) {
+                        for (int dx = 0; dx < cellSize; ++dx) {
+                            BlockType type = snapshot.getBlock(x + dx, y + dy, z + dz);
+                            counts[static_cast<int>(type)]++;
+                            if (Block::getInfo(type).opaque) opaqueCount++;
+                        }
+                    }
+                }
+
+                // Same rule as FaceCulling::downsample decides opaque or not,
+                // then the most common block of that kind fills the cell
+                const bool opaque = opaqueCount * 2 >= cellVolume;
+                BlockType majority = BlockType::Air;
+                int best = 0;
+                for (int t = 0; t < BLOCK_TYPE_COUNT; ++t) {
+                    BlockType type = static_cast<BlockType>(t);
+                    if (counts[t] > best && Block::getInfo(type).opaque == opaque) {
+                        best = counts[t];
+                        majority = type;
+                    }
+                }
+
+                for (int dy = 0; dy < cellSize; ++dy) {
+                    for (int dz = 0; dz < cellSize; ++dz) {
+                        for (int dx = 0; dx < cellSize; ++dx) {
+                            snapshot.blocks[ChunkLayout::linearIndex(x + dx, y + dy, z + dz)] = majority;
+                        }
+                    }
+                }
+            }
+        }
+    }
 }
 
-// TODO figure out wtf is wrong withthis 
-void Chunk::generateDirtyMesh() {
-    m_DirtyFaces = 0;
-    generateMesh();
-    return;
-for (int face = 0; face < 6; ++face) {
-        // If the current face is not marked as dirty leave it alone
-        if (!(m_DirtyFaces & (1 << face)))
-            continue;
+void Chunk::computeVisibleFaces(const ChunkSnapshot& snapshot, VisibleFaces& visible) {
+    std::array<const FaceCulling::Mask*, 6> neighbors;
+    for (int face = 0; face < 6; ++face) {
+        neighbors[face] = &snapshot.neighborBorders[face];
+    }
 
-        // MeshPack& facePack = m_FaceMeshPacks[face];
-        // facePack.vertices.clear();
-        // facePack.indices.clear();
+    // Faces are emitted for rendered blocks. While every rendered block is opaque
+    // the opaque mask already is that set, otherwise build it
+    if constexpr (renderedMatchesOpaque()) {
+        FaceCulling::computeVisibleFaces(snapshot.opaque, snapshot.opaque, neighbors, visible);
+    } else {
+        static thread_local FaceCulling::Mask rendered;
+        rendered.fill(0);
+        for (int i = 0; i < kChunkVolume; ++i) {
+            if (Block::getInfo(snapshot.blocks[i]).rendered) rendered[i >> 6] |= uint64_t(1) << (i & 63);
+        }
+        FaceCulling::computeVisibleFaces(rendered, snapshot.opaque, neighbors, visible);
+    }
+}
 
-        int faceVertexCount = 0;
+void Chunk::generateNaiveMesh(MeshPack& pack, const ChunkSnapshot& snapshot, const VisibleFaces& visible, int face) {
+    // Only visit voxels whose face is exposed
+    for (int w = 0; w < kOpaqueMaskWords; ++w) {
+        uint64_t exposed = visible[face][w];
+        while (exposed) {
+            int bit = w * 64 + countTrailingZeros64(exposed);
+            exposed &= exposed - 1;
 
-        for (int y = 0; y < kChunkHeight; ++y) {
-            for (int z = 0; z < kChunkDepth; ++z) {
-                for (int x = 0; x < kChunkWidth; ++x) {
-                    BlockType block = getBlock(x, y, z);
-                    if (block == BlockType::Air) continue;
+            int x = bit % kChunkWidth;
+            int z = (bit / kChunkWidth) % kChunkDepth;
+            int y = bit / (kChunkWidth * kChunkDepth);
 
-                    int nx = x + neighborOffsets[face].x;
-                    int ny = y + neighborOffsets[face].y;
-                    int nz = z + neighborOffsets[face].z;
+            int tile = faceTileIndices[static_cast<int>(snapshot.getBlock(x, y, z))][face];
+            Block::defineFace(pack, face, tile, glm::ivec3(x, y, z));
+        }
+    }
+}
 
-                    bool outOfBounds = (nx < 0 || ny < 0 || nz < 0 ||
-                                        nx >= kChunkWidth || ny >= kChunkHeight || nz >= kChunkDepth);
+void Chunk::generateGreedyMesh(MeshPack& pack, const ChunkSnapshot& snapshot, const VisibleFaces& visible, int face) {
+    constexpr int dims[3] = {kChunkWidth, kChunkHeight, kChunkDepth};
+    constexpr int kMaxSliceArea = std::max({kChunkWidth * kChunkHeight, kChunkWidth * kChunkDepth,
+                                            kChunkHeight * kChunkDepth});
+
+    // Per-slice face mask: 0 = no visible face, otherwise 1 + the face's atlas tile index.
+    // Faces only merge when their tiles match, so texturing survives the merge.
+    static thread_local std::array<uint16_t, kMaxSliceArea> mask;
+
+    const FaceAxes& axes = faceAxes[face];
+    const int uSize = dims[axes.u];
+    const int vSize = dims[axes.v];
+    const int layers = dims[axes.normal];
+    const bool positive = neighborOffsets[face][axes.normal] > 0;
+
+    for (int layer = 0; layer < layers; ++layer) {
+        // A uniform chunk can only show faces on its outer shell
+        if (snapshot.uniform && layer != (positive ? layers - 1 : 0)) continue;
+
+        bool anyFaces = false;
+        glm::ivec3 pos;
+        pos[axes.normal] = layer;
+        for (int v = 0; v < vSize; ++v) {
+            pos[axes.v] = v;
+            for (int u = 0; u < uSize; ++u) {
+                pos[axes.u] = u;
+                uint16_t& cell = mask[u + v * uSize];
+                cell = 0;
+
+                int bit = opaqueBit(pos.x, pos.y, pos.z);
+                if (!((visible[face][bit >> 6] >> (bit & 63)) & 1)) continue;
+
+                cell = 1 + faceTileIndices[static_cast<int>(snapshot.getBlock(pos.x, pos.y, pos.z))][face];
+                anyFaces = true;
+            }
+        }
+        if (!anyFaces) continue;
+
+        // Grow each unclaimed cell along u, then along v while whole rows match
+        for (int v = 0; v < vSize; ++v) {
+            for (int u = 0; u < uSize; ) {
+                uint16_t key = mask[u + v * uSize];
+                if (key == 0) {
+                    ++u;
+                    continue;
+                }
 
-                    if (outOfBounds || getBlock(nx, ny, nz) == BlockType::Air) {
-                        std::optional<Block> b = getBlockObj(x, y, z);
-                        if (!b.has_value()) continue;
+                int width = 1;
+                while (u + width < uSize && mask[u + width + v * uSize] == key) ++width;
 
-                        std::vector<bool> faceFlags(6, false);
-                        faceFlags[face] = true;
+                int height = 1;
+                while (v + height < vSize) {
+                    const uint16_t* row = &mask[u + (v + height) * uSize];
+                    if (!std::all_of(row, row + width, [key](uint16_t c) { return c == key; })) break;
+                    ++height;
+                }
 
-                        // int baseIndex = facePack.vertices.size() / 5;
-                        // b->defineRenderedFaces(m_FaceMeshPacks, faceFlags);
-                    }
+                for (int dv = 0; dv < height; ++dv) {
+                    std::fill_n(&mask[u + (v + dv) * uSize], width, uint16_t(0));
                 }
+
+                pos[axes.u] = u;
+                pos[axes.v] = v;
+                Block::defineFace(pack, face, key - 1, pos, width, height);
+
+                u += width;
             }
         }
     }
+}
 
-    // Merge all face packs
-    MeshPack final;
-    /*for (const auto& facePack : m_FaceMeshPacks) {
-        int offset = final.vertices.size() / 5;
+void Chunk::remeshFaceTowardsNeighbor(int faceIndex) {
+    assert(faceIndex <= 6 && faceIndex >= 0);
+    markFaceDirty(faceIndex);
 
-        final.vertices.insert(final.vertices.end(), facePack.vertices.begin(), facePack.vertices.end());
-        for (unsigned int idx : facePack.indices)
-            final.indices.push_back(idx + offset);
-    }*/
+    glm::ivec3 chunkCoords = glm::ivec3(m_Position) / glm::ivec3(kChunkWidth, kChunkHeight, kChunkDepth);
+    m_World->queueChunkForRemeshing(chunkCoords);
+}
 
-    m_Mesh = std::make_unique<Mesh>(final);
-    m_Mesh->setupMesh();
-    m_DirtyFaces = 0;
+void Chunk::markFaceDirty(int faceIndex) {
+    assert(faceIndex <= 6 && faceIndex >= 0);
+    m_DirtyFaces |= (1 << faceIndex);
 }
 
-void Chunk::draw() const {
-    if (!m_Mesh) return;
-    m_Mesh->draw();
+void Chunk::markAllFacesDirty() {
+    m_DirtyFaces = kAllFaces;
 }
 
-BlockType Chunk::getBlock(int x, int y, int z) const {
-    assert(x >= 0 && x < kChunkWidth);
-    assert(y >= 0 && y < kChunkHeight);
-    assert(z >= 0 && z < kChunkDepth);
+bool Chunk::hasDirtyFaces() const {
+    return m_DirtyFaces != 0;
+}
 
-    if (m_Mode == StorageMode::Dense) {
-        return m_Blocks[index(x, y, z)];
-    }
+uint8_t Chunk::getFacesTowards(const glm::vec3& cameraPos) const {
+    // Blocks span x - 0.5..x + 0.5, y..y + 1, z - 0.5..z + 0.5
+    const glm::vec3 min = m_Position - glm::vec3(0.5f, 0.0f, 0.5f);
+    const glm::vec3 max = min + glm::vec3(kChunkWidth, kChunkHeight, kChunkDepth);
+
+    // A face pointing down an axis is only seen from below its plane, and the
+    // planes of this chunk's faces all lie within the AABB
+    uint8_t faces = 0;
+    if (cameraPos.z < max.z) faces |= 1 << 0;
+    if (cameraPos.z > min.z) faces |= 1 << 1;
+    if (cameraPos.x < max.x) faces |= 1 << 2;
+    if (cameraPos.x > min.x) faces |= 1 << 3;
+    if (cameraPos.y < max.y) faces |= 1 << 4;
+    if (cameraPos.y > min.y) faces |= 1 << 5;
+    return faces;
+}
 
-    return m_Sparse->getBlock(x, y, z);
+void Chunk::draw(GLint transformLocation, const glm::vec3& cameraPos, uint8_t faceMask) const {
+    if (!m_Mesh) return;
+    // Mesh vertices are chunk-local, the offset to the camera is small wherever the chunk is
+    glm::mat4 transform = glm::translate(glm::mat4(1.0f), m_Position - cameraPos);
+    glUniformMatrix4fv(transformLocation, 1, GL_FALSE, &transform[0][0]);
+    m_Mesh->draw(faceMask);
 }
 
-std::optional<Block> Chunk::getBlockObj(int x, int y, int z) const {
+BlockType Chunk::getBlock(int x, int y, int z) const {
     assert(x >= 0 && x < kChunkWidth);
     assert(y >= 0 && y < kChunkHeight);
     assert(z >= 0 && z < kChunkDepth);
-    return m_BlockObjs[index(x, y, z)];
-}
-
 
+    switch (m_Mode) {
+        case StorageMode::Dense:
+            return m_Blocks[index(x, y, z)];
+        case StorageMode::Palette:
+            return m_Palette->getBlock(index(x, y, z));
+        case StorageMode::Uniform:
+            return m_UniformType;
+        default:
+            return m_Sparse->getBlock(index(x, y, z));
+    }
+}
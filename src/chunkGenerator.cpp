@@ -1,5 +1,9 @@
 #include "ChunkGenerator.hpp"
 
+#include <algorithm>
+#include <array>
+#include <limits>
+
 std::unique_ptr<Chunk> ChunkGenerator::generateChunk(int cx, int cy, int cz) {
     // populate stone canvas
     auto chunk = populateChunk(cx, cy, cz);
@@ -20,22 +24,52 @@ std::unique_ptr<Chunk> ChunkGenerator::populateChunk(int cx, int cy, int cz)
         BlockType type;
     };
 
-    std::vector<BlockSet> placedBlocks;
-    placedBlocks.reserve(Chunk::kChunkWidth * Chunk::kChunkHeight * Chunk::kChunkDepth);
-
     float worldOffsetX = cx * Chunk::kChunkWidth;
     float worldOffsetY = cy * Chunk::kChunkHeight;
     float worldOffsetZ = cz * Chunk::kChunkDepth;
 
-    // Iterate through each block in the chunk and store its info based on noise maps
+    glm::vec3 chunkPos(worldOffsetX, worldOffsetY, worldOffsetZ);
+
+    // Sample each column's terrain height once. If every column clears the
+    // chunk entirely (or none reaches it) we know the result without visiting voxels.
+    std::array<int, Chunk::kChunkWidth * Chunk::kChunkDepth> heights;
+    int minHeight = std::numeric_limits<int>::max();
+    int maxHeight = std::numeric_limits<int>::min();
+
     for (int z = 0; z < Chunk::kChunkDepth; z++) {
         int worldZ = worldOffsetZ + z;
         for (int x = 0; x < Chunk::kChunkWidth; x++) {
             int worldX = worldOffsetX + x;
 
             int terrainHeight = getHeight(worldX, worldZ);
+            heights[x + z * Chunk::kChunkWidth] = terrainHeight;
+            minHeight = std::min(minHeight, terrainHeight);
+            maxHeight = std::max(maxHeight, terrainHeight);
+        }
+    }
 
-            for (int y = 0; y < Chunk::kChunkHeight; y++) {
+    if (maxHeight <= worldOffsetY) {
+        return nullptr; // all air
+    }
+
+    if (minHeight >= worldOffsetY + Chunk::kChunkHeight) {
+        // Fully below the surface, a single stone value describes the chunk
+        return std::make_unique<Chunk>(m_World, chunkPos, Chunk::StorageMode::Uniform, BlockType::Stone);
+    }
+
+    // Reused between chunks so streaming terrain doesn't allocate a scratch list per chunk
+    static thread_local std::vector<BlockSet> placedBlocks;
+    placedBlocks.clear();
+    placedBlocks.reserve(Chunk::kChunkVolume);
+
+    // Iterate through each block in the chunk and store its info based on noise maps
+    for (int z = 0; z < Chunk::kChunkDepth; z++) {
+        for (int x = 0; x < Chunk::kChunkWidth; x++) {
+            int terrainHeight = heights[x + z * Chunk::kChunkWidth];
+
+            // Everything above the column's surface is air, don't visit it
+            int columnTop = std::min(Chunk::kChunkHeight, terrainHeight - static_cast<int>(worldOffsetY));
+            for (int y = 0; y < columnTop; y++) {
                 int worldY = worldOffsetY + y;
                 BlockType type = BlockType::Air;
 
@@ -57,21 +91,12 @@ std::unique_ptr<Chunk> ChunkGenerator::populateChunk(int cx, int cy, int cz)
         return nullptr; // all air
     }
 
-    // Determine what kind of chunk we should use based on how many blocks it contains
-    float fillRatio = static_cast<float>(placedBlocks.size()) /
-                      (Chunk::kChunkWidth * Chunk::kChunkHeight * Chunk::kChunkDepth);
-
-    Chunk::StorageMode mode = (fillRatio < 0.1f)
-        ? Chunk::StorageMode::Sparse
-        : Chunk::StorageMode::Dense;
+    // Determine what kind of chunk we should use based on how many blocks it contains.
+    // The chunk migrates on its own afterwards if edits change that
+    Chunk::StorageMode mode = Chunk::storageModeForFill(static_cast<int>(placedBlocks.size()));
 
     // Create the new chunk
-    auto chunk = std::make_unique<Chunk>(
-        m_World,
-        glm::vec3(cx * Chunk::kChunkWidth,
-                  cy * Chunk::kChunkHeight,
-                  cz * Chunk::kChunkDepth),
-        mode);
+    auto chunk = std::make_unique<Chunk>(m_World, chunkPos, mode);
 
     // Set the blocks in the new chunk from our list created earlier
     for (const auto& b : placedBlocks) {
@@ -0,0 +1,204 @@
+#include "FaceCulling.hpp"
+#include "BitUtils.hpp"
+
+namespace {
+    constexpr int kWidth = ChunkConfig::kWidth;
+    constexpr int kHeight = ChunkConfig::kHeight;
+    constexpr int kDepth = ChunkConfig::kDepth;
+    constexpr int kSlabWords = kWidth * kDepth / 64; // Words per y layer
+    constexpr int kWords = FaceCulling::kWords;
+
+    // Repeats a row pattern across every row packed in a word
+    constexpr uint64_t repeatRows(uint64_t row) {
+        uint64_t word = 0;
+        for (int shift = 0; shift < 64; shift += kWidth) word |= row << shift;
+        return word;
+    }
+
+    constexpr uint64_t kFirstColumn = repeatRows(1);                          // x == 0
+    constexpr uint64_t kLastColumn = repeatRows(uint64_t(1) << (kWidth - 1)); // x == kWidth - 1
+
+    // Opaque bits of row z - 1 moved onto row z. prev is the word holding the rows just before word
+    inline uint64_t shiftRowsUp(uint64_t word, uint64_t prev) {
+        if constexpr (kWidth == 64) return prev;
+        else return (word << kWidth) | (prev >> (64 - kWidth));
+    }
+
+    // Opaque bits of row z + 1 moved onto row z. next is the word holding the rows just after word
+    inline uint64_t shiftRowsDown(uint64_t word, uint64_t next) {
+        if constexpr (kWidth == 64) return next;
+        else return (word >> kWidth) | (next << (64 - kWidth));
+    }
+
+    constexpr uint64_t kFirstRow = (kWidth == 64) ? ~uint64_t(0) : (uint64_t(1) << kWidth) - 1; // Lowest row of a word
+    constexpr uint64_t kLastRow = kFirstRow << (64 - kWidth);                                     // Highest row of a word
+    constexpr int kWrap = (kHeight - 1) * kSlabWords; // First word of the top y layer
+
+    const FaceCulling::Mask kUnloaded{};
+}
+
+void FaceCulling::copyBorder(const Mask& neighbor, int face, Mask& border) {
+    border.fill(0);
+    switch (face) {
+        case 0: // -z neighbor: its z == kDepth - 1 rows
+            for (int slab = 0; slab < kWords; slab += kSlabWords) {
+                border[slab + kSlabWords - 1] = neighbor[slab + kSlabWords - 1] & kLastRow;
+            }
+            break;
+        case 1: // +z neighbor: its z == 0 rows
+            for (int slab = 0; slab < kWords; slab += kSlabWords) {
+                border[slab] = neighbor[slab] & kFirstRow;
+            }
+            break;
+        case 2: // -x neighbor: its x == kWidth - 1 column
+            for (int w = 0; w < kWords; ++w) border[w] = neighbor[w] & kLastColumn;
+            break;
+        case 3: // +x neighbor: its x == 0 column
+            for (int w = 0; w < kWords; ++w) border[w] = neighbor[w] & kFirstColumn;
+            break;
+        case 4: // -y neighbor: its top layer
+            for (int w = kWrap; w < kWords; ++w) border[w] = neighbor[w];
+            break;
+        case 5: // +y neighbor: its bottom layer
+            for (int w = 0; w < kSlabWords; ++w) border[w] = neighbor[w];
+            break;
+    }
+}
+
+bool FaceCulling::bordersTouch(const Mask& solid, const Mask& neighbor, int face) {
+    uint64_t touching = 0;
+    switch (face) {
+        case 0: // Our z == 0 rows against the neighbor's z == kDepth - 1 rows
+            for (int slab = 0; slab < kWords; slab += kSlabWords) {
+                touching |= solid[slab] & ((neighbor[slab + kSlabWords - 1] & kLastRow) >> (64 - kWidth));
+            }
+            break;
+        case 1: // Our z == kDepth - 1 rows against the neighbor's z == 0 rows
+            for (int slab = 0; slab < kWords; slab += kSlabWords) {
+                touching |= solid[slab + kSlabWords - 1] & ((neighbor[slab] & kFirstRow) << (64 - kWidth));
+            }
+            break;
+        case 2: // Our x == 0 column against the neighbor's x == kWidth - 1 column
+            for (int w = 0; w < kWords; ++w) {
+                touching |= solid[w] & kFirstColumn & (neighbor[w] >> (kWidth - 1));
+            }
+            break;
+        case 3: // Our x == kWidth - 1 column against the neighbor's x == 0 column
+            for (int w = 0; w < kWords; ++w) {
+                touching |= solid[w] & kLastColumn & (neighbor[w] << (kWidth - 1));
+            }
+            break;
+        case 4: // Our bottom layer against the neighbor's top layer
+            for (int w = 0; w < kSlabWords; ++w) touching |= solid[w] & neighbor[w + kWrap];
+            break;
+        case 5: // Our top layer against the neighbor's bottom layer
+            for (int w = 0; w < kSlabWords; ++w) touching |= solid[w + kWrap] & neighbor[w];
+            break;
+    }
+    return touching != 0;
+}
+
+void FaceCulling::downsample(const Mask& mask, int cellSize, Mask& out) {
+    const uint64_t cellRow = (uint64_t(1) << cellSize) - 1;
+    const int cellVolume = cellSize * cellSize * cellSize;
+
+    out.fill(0);
+    for (int y = 0; y < kHeight; y += cellSize) {
+        for (int z = 0; z < kDepth; z += cellSize) {
+            for (int x = 0; x < kWidth; x += cellSize) {
+                int count = 0;
+                for (int dy = 0; dy < cellSize; ++dy) {
+                    for (int dz = 0; dz < cellSize; ++dz) {
+                        int bit = x + kWidth * ((z + dz) + kDepth * (y + dy));
+                        count += popcount64((mask[bit >> 6] >> (bit & 63)) & cellRow);
+                    }
+                }
+                // Ties count as set so coarse surfaces stay closed
+                if (count * 2 < cellVolume) continue;
+
+                for (int dy = 0; dy < cellSize; ++dy) {
+                    for (int dz = 0; dz < cellSize; ++dz) {
+                        int bit = x + kWidth * ((z + dz) + kDepth * (y + dy));
+                        out[bit >> 6] |= cellRow << (bit & 63);
+                    }
+                }
+            }
+        }
+    }
+}
+
+bool FaceCulling::isBorderFull(const Mask& mask, int face) {
+    switch (face) {
+        case 0:
+            for (int slab = 0; slab < kWords; slab += kSlabWords) {
+                if ((mask[slab] & kFirstRow) != kFirstRow) return false;
+            }
+            return true;
+        case 1:
+            for (int slab = 0; slab < kWords; slab += kSlabWords) {
+                if ((mask[slab + kSlabWords - 1] & kLastRow) != kLastRow) return false;
+            }
+            return true;
+        case 2:
+            for (int w = 0; w < kWords; ++w) {
+                if ((mask[w] & kFirstColumn) != kFirstColumn) return false;
+            }
+            return true;
+        case 3:
+            for (int w = 0; w < kWords; ++w) {
+                if ((mask[w] & kLastColumn) != kLastColumn) return false;
+            }
+            return true;
+        case 4:
+            for (int w = 0; w < kSlabWords; ++w) {
+                if (mask[w] != ~uint64_t(0)) return false;
+            }
+            return true;
+        case 5:
+            for (int w = 0; w < kSlabWords; ++w) {
+                if (mask[w + kWrap] != ~uint64_t(0)) return false;
+            }
+            return true;
+    }
+    return false;
+}
+
+void FaceCulling::computeVisibleFaces(const Mask& solid, const Mask& opaque,
+                                      const std::array<const Mask*, 6>& neighbors,
+                                      std::array<Mask, 6>& visible) {
+    const Mask& negZ = neighbors[0] ? *neighbors[0] : kUnloaded;
+    const Mask& posZ = neighbors[1] ? *neighbors[1] : kUnloaded;
+    const Mask& negX = neighbors[2] ? *neighbors[2] : kUnloaded;
+    const Mask& posX = neighbors[3] ? *neighbors[3] : kUnloaded;
+    const Mask& negY = neighbors[4] ? *neighbors[4] : kUnloaded;
+    const Mask& posY = neighbors[5] ? *neighbors[5] : kUnloaded;
+
+    // -x / +x: shift within each row. The edge column comes from the opposite
+    // edge of the neighboring chunk, which sits in the same word of its mask.
+    for (int w = 0; w < kWords; ++w) {
+        uint64_t west = ((opaque[w] << 1) & ~kFirstColumn) | ((negX[w] >> (kWidth - 1)) & kFirstColumn);
+        uint64_t east = ((opaque[w] >> 1) & ~kLastColumn) | ((posX[w] << (kWidth - 1)) & kLastColumn);
+        visible[2][w] = solid[w] & ~west;
+        visible[3][w] = solid[w] & ~east;
+    }
+
+    // -z / +z: shift whole rows through each y layer. At z == 0 / kDepth - 1 the
+    // missing row is the last / first row of the same layer in the neighbor.
+    for (int slab = 0; slab < kWords; slab += kSlabWords) {
+        for (int i = 0; i < kSlabWords; ++i) {
+            int w = slab + i;
+            uint64_t prev = (i > 0) ? opaque[w - 1] : negZ[slab + kSlabWords - 1];
+            uint64_t next = (i < kSlabWords - 1) ? opaque[w + 1] : posZ[slab];
+            visible[0][w] = solid[w] & ~shiftRowsUp(opaque[w], prev);
+            visible[1][w] = solid[w] & ~shiftRowsDown(opaque[w], next);
+        }
+    }
+
+    // -y / +y: a y step is exactly kSlabWords words
+    for (int w = 0; w < kWords; ++w) {
+        uint64_t below = (w >= kSlabWords) ? opaque[w - kSlabWords] : negY[w + kWrap];
+        uint64_t above = (w < kWords - kSlabWords) ? opaque[w + kSlabWords] : posY[w - kWrap];
+        visible[4][w] = solid[w] & ~below;
+        visible[5][w] = solid[w] & ~above;
+    }
+}
@@ -0,0 +1,48 @@
+#include "MeshCache.hpp"
+
+MeshCache::MeshCache(size_t maxBytes)
+    : m_MaxBytes(maxBytes) {
+}
+
+bool MeshCache::find(uint64_t key, FaceMeshes& faces) {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    auto it = m_Index.find(key);
+    if (it == m_Index.end()) {
+        m_Misses++;
+        return false;
+    }
+
+    m_Entries.splice(m_Entries.begin(), m_Entries, it->second);
+    faces = it->second->faces;
+    m_Hits++;
+    return true;
+}
+
+void MeshCache::insert(uint64_t key, const FaceMeshes& faces) {
+    size_t bytes = 0;
+    for (const auto& facePack : faces) {
+        bytes += facePack->vertices.size() * sizeof(PackedVertex) + facePack->indices.size() * sizeof(unsigned int);
+    }
+    if (bytes > m_MaxBytes) return;
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    // Another job may have built the same content meanwhile
+    if (m_Index.count(key)) return;
+
+    m_Entries.push_front({key, faces, bytes});
+    m_Index[key] = m_Entries.begin();
+    m_Bytes += bytes;
+
+    while (m_Bytes > m_MaxBytes) {
+        const Entry& oldest = m_Entries.back();
+        m_Bytes -= oldest.bytes;
+        m_Index.erase(oldest.key);
+        m_Entries.pop_back();
+        m_Evictions++;
+    }
+}
+
+MeshCache::Stats MeshCache::getStats() const {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return {m_Hits, m_Misses, m_Evictions, m_Entries.size(), m_Bytes};
+}
@@ -0,0 +1,88 @@
+#include "PaletteChunkData.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+PaletteChunkData::PaletteChunkData(int volume, BlockType fill)
+    : m_Palette{fill},
+    m_RefCounts{static_cast<uint32_t>(volume)},
+    m_Data((volume + 63) / 64, 0), // 1 bit per voxel, every voxel -> entry 0
+    m_Volume(volume) {
+    }
+
+void PaletteChunkData::decode(BlockType* out) const {
+    switch (m_BitsPerEntry) {
+        case 1: decodeEntries<1>(out); break;
+        case 2: decodeEntries<2>(out); break;
+        case 4: decodeEntries<4>(out); break;
+        case 8: decodeEntries<8>(out); break;
+    }
+}
+
+template <int kBits>
+void PaletteChunkData::decodeEntries(BlockType* out) const {
+    constexpr int kEntriesPerWord = 64 / kBits;
+    constexpr uint64_t kMask = (uint64_t(1) << kBits) - 1;
+    const BlockType* palette = m_Palette.data();
+
+    for (int i = 0; i < m_Volume; i += kEntriesPerWord) {
+        uint64_t word = m_Data[i / kEntriesPerWord];
+        int count = std::min(kEntriesPerWord, m_Volume - i);
+        for (int e = 0; e < count; e++) {
+            out[i + e] = palette[(word >> (e * kBits)) & kMask];
+        }
+    }
+}
+
+void PaletteChunkData::setBlock(int index, BlockType type) {
+    uint32_t oldEntry = readEntry(index);
+    if (m_Palette[oldEntry] == type) return;
+
+    // Looking up the new entry can widen m_Data, entry values stay the same
+    uint32_t newEntry = findOrAddEntry(type);
+
+    m_RefCounts[oldEntry]--;
+    m_RefCounts[newEntry]++;
+    writeEntry(index, newEntry);
+}
+
+uint32_t PaletteChunkData::findOrAddEntry(BlockType type) {
+    int freeSlot = -1;
+    for (size_t i = 0; i < m_Palette.size(); i++) {
+        if (m_RefCounts[i] == 0) {
+            if (freeSlot < 0) freeSlot = static_cast<int>(i);
+            continue;
+        }
+        if (m_Palette[i] == type) return static_cast<uint32_t>(i);
+    }
+
+    // Recycle an entry no voxel references anymore before growing the palette
+    if (freeSlot >= 0) {
+        m_Palette[freeSlot] = type;
+        return static_cast<uint32_t>(freeSlot);
+    }
+
+    if (m_Palette.size() >= (size_t(1) << m_BitsPerEntry)) {
+        widen();
+    }
+
+    m_Palette.push_back(type);
+    m_RefCounts.push_back(0);
+    return static_cast<uint32_t>(m_Palette.size() - 1);
+}
+
+void PaletteChunkData::widen() {
+    // BlockType is a single byte so 8 bits always covers every possible palette
+    assert(m_BitsPerEntry < 8);
+
+    int newBits = m_BitsPerEntry * 2;
+    std::vector<uint64_t, PoolAllocator<uint64_t>> newData((m_Volume * newBits + 63) / 64, 0);
+
+    for (int i = 0; i < m_Volume; i++) {
+        int bit = i * newBits;
+        newData[bit >> 6] |= uint64_t(readEntry(i)) << (bit & 63);
+    }
+
+    m_Data = std::move(newData);
+    m_BitsPerEntry = newBits;
+}
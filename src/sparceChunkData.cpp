@@ -1,17 +1,44 @@
 #include "SparseChunkData.hpp"
 
-void SparseChunkData::setBlock(int x, int y, int z, BlockType type) {
-    glm::ivec3 pos(x, y, z);
-    if (type == BlockType::Air) {
-        m_Blocks.erase(pos);
-        return;
+#include <algorithm>
+
+SparseChunkData::SparseChunkData(int volume)
+    : m_Mask((volume + 63) / 64, 0),
+    m_WordRanks((volume + 63) / 64, 0) {
     }
 
-    m_Blocks[pos] = type;
+void SparseChunkData::decode(BlockType* out) const {
+    const BlockType* value = m_Values.data();
+    for (size_t word = 0; word < m_Mask.size(); word++) {
+        BlockType* voxels = out + word * 64;
+        std::fill_n(voxels, 64, BlockType::Air);
+        for (uint64_t bits = m_Mask[word]; bits; bits &= bits - 1) {
+            voxels[countTrailingZeros64(bits)] = *value++;
+        }
+    }
 }
 
-BlockType SparseChunkData::getBlock(int x, int y, int z) const {
-    glm::ivec3 pos(x, y, z);
-    auto it = m_Blocks.find(pos);
-    return it != m_Blocks.end() ? it->second : BlockType::Air;
+void SparseChunkData::setBlock(int index, BlockType type) {
+    int word = index >> 6;
+    uint64_t bit = uint64_t(1) << (index & 63);
+    bool present = (m_Mask[word] & bit) != 0;
+    int slot = rank(index);
+
+    if (present) {
+        if (type != BlockType::Air) {
+            m_Values[slot] = type;
+            return;
+        }
+
+        m_Values.erase(m_Values.begin() + slot);
+        m_Mask[word] &= ~bit;
+        for (size_t w = word + 1; w < m_WordRanks.size(); w++) m_WordRanks[w]--;
+        return;
+    }
+
+    if (type == BlockType::Air) return;
+
+    m_Values.insert(m_Values.begin() + slot, type);
+    m_Mask[word] |= bit;
+    for (size_t w = word + 1; w < m_WordRanks.size(); w++) m_WordRanks[w]++;
 }
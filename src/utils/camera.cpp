@@ -24,6 +24,10 @@ glm::mat4 Camera::getViewMatrix() const {
     return glm::lookAt(m_Position, m_Position + m_Front, m_Up);
 }
 
+glm::mat4 Camera::getRotationViewMatrix() const {
+    return glm::lookAt(glm::vec3(0.0f), m_Front, m_Up);
+}
+
 glm::mat4 Camera::getProjectionMatrix(float aspectRatio) const {
     return glm::perspective(glm::radians(45.0f), aspectRatio, 0.1f, 1000.0f);
 }
@@ -1,5 +1,8 @@
 #include "Mesh.hpp"
 
+#include <cstdint>
+#include <utility>
+
 Mesh::Mesh(const MeshPack& pack)
     : m_MeshPack(pack) {
         if (pack.vertices.size() == 0 || pack.indices.size() == 0) {
@@ -8,6 +11,10 @@ Mesh::Mesh(const MeshPack& pack)
         // setupMesh();
 }
 
+Mesh::Mesh(MeshPack&& pack)
+    : m_MeshPack(std::move(pack)) {
+}
+
 Mesh::~Mesh() {
     glDeleteVertexArrays(1, &m_VAO);
     glDeleteBuffers(1, &m_VBO);
@@ -22,29 +29,47 @@ void Mesh::setupMesh() {
     glBindVertexArray(m_VAO);
 
     glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
-    glBufferData(GL_ARRAY_BUFFER, m_MeshPack.vertices.size() * sizeof(float), m_MeshPack.vertices.data(), GL_STATIC_DRAW);
+    glBufferData(GL_ARRAY_BUFFER, m_MeshPack.vertices.size() * sizeof(PackedVertex), m_MeshPack.vertices.data(), GL_STATIC_DRAW);
 
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_EBO);
     glBufferData(GL_ELEMENT_ARRAY_BUFFER, m_MeshPack.indices.size() * sizeof(unsigned int), m_MeshPack.indices.data(), GL_STATIC_DRAW);
 
-    // Position attribute
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
+    // Packed corner position and face/tile, decoded in vertex.glsl
+    glVertexAttribIPointer(0, 4, GL_UNSIGNED_SHORT, sizeof(PackedVertex), (void*)0);
     glEnableVertexAttribArray(0);
 
-    // Texture attribute
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-
-    // TODO: implement then enable normal attribute:
-    // glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(5 * sizeof(float)));
-    // glEnableVertexAttribArray(2);
+    // TODO: normals for lighting can be looked up from the packed face index
 
     glBindBuffer(GL_ARRAY_BUFFER, 0);
     glBindVertexArray(0);
+
+    // The GPU has its own copy now. Chunks keep their per-direction sub-meshes
+    m_IndexCount = m_MeshPack.indices.size();
+    m_FaceStarts = m_MeshPack.faceStarts;
+    m_MeshPack = MeshPack();
 }
 
 void Mesh::draw() const {
     glBindVertexArray(m_VAO);
-    glDrawElements(GL_TRIANGLES, m_MeshPack.indices.size(), GL_UNSIGNED_INT, 0);
+    glDrawElements(GL_TRIANGLES, m_IndexCount, GL_UNSIGNED_INT, 0);
+    glBindVertexArray(0);
+}
+
+void Mesh::draw(uint8_t faceMask) const {
+    GLsizei counts[6];
+    const void* offsets[6];
+    GLsizei ranges = 0;
+    for (int face = 0; face < 6; ++face) {
+        if (!(faceMask & (1 << face))) continue;
+        GLsizei count = m_FaceStarts[face + 1] - m_FaceStarts[face];
+        if (count == 0) continue;
+        counts[ranges] = count;
+        offsets[ranges] = reinterpret_cast<const void*>(static_cast<uintptr_t>(m_FaceStarts[face]) * sizeof(unsigned int));
+        ranges++;
+    }
+    if (ranges == 0) return;
+
+    glBindVertexArray(m_VAO);
+    glMultiDrawElements(GL_TRIANGLES, counts, GL_UNSIGNED_INT, offsets, ranges);
     glBindVertexArray(0);
 }
@@ -68,6 +68,14 @@ std::string ShaderProgram::readFile(const std::string& filePath) {
     return buffer.str();
 }
 
+GLint ShaderProgram::getUniformLocation(const std::string& name) const {
+    GLint location = glGetUniformLocation(m_Program, name.c_str());
+    if (location == -1) {
+        std::cerr << "Warning: uniform '" << name << "' doesn't exist!" << std::endl;
+    }
+    return location;
+}
+
 void ShaderProgram::setUniform(const std::string& name, const glm::mat4& matrix) {
     GLint location = glGetUniformLocation(m_Program, name.c_str());
     if (location == -1) {
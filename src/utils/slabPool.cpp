@@ -0,0 +1,168 @@
+#include "SlabPool.hpp"
+
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <new>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+#ifndef VOXEL_POOL_USE_MMAP
+#define VOXEL_POOL_USE_MMAP 1
+#endif
+
+namespace {
+    // Every live pool, so stats can be collected without knowing who owns them.
+    // Intentionally leaked so pools destroyed during static teardown can still unregister
+    std::mutex& registryMutex() {
+        static std::mutex* mutex = new std::mutex();
+        return *mutex;
+    }
+
+    std::vector<SlabPool*>& registry() {
+        static std::vector<SlabPool*>* pools = new std::vector<SlabPool*>();
+        return *pools;
+    }
+}
+
+SlabPool::SlabPool(const char* name, size_t blockSize, bool useMmap)
+    : m_Name(name),
+    m_UseMmap(useMmap) {
+        // Every block has to be able to hold a free list link and stay aligned
+        constexpr size_t align = alignof(std::max_align_t);
+        m_BlockSize = (std::max(blockSize, sizeof(FreeBlock)) + align - 1) / align * align;
+        m_BlocksPerSlab = std::max<size_t>(1, kSlabBytes / m_BlockSize);
+
+        std::lock_guard<std::mutex> lock(registryMutex());
+        registry().push_back(this);
+    }
+
+SlabPool::~SlabPool() {
+    {
+        std::lock_guard<std::mutex> lock(registryMutex());
+        auto& pools = registry();
+        pools.erase(std::remove(pools.begin(), pools.end(), this), pools.end());
+    }
+
+    size_t slabBytes = m_BlockSize * m_BlocksPerSlab;
+    for (void* slab : m_Slabs) {
+#ifdef __linux__
+        if (m_UseMmap) {
+            munmap(slab, slabBytes);
+            continue;
+        }
+#endif
+        ::operator delete(slab);
+    }
+}
+
+void* SlabPool::allocate() {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    if (!m_FreeList) addSlab();
+
+    FreeBlock* block = m_FreeList;
+    m_FreeList = block->next;
+
+    m_InUse++;
+    m_HighWater = std::max(m_HighWater, m_InUse);
+    return block;
+}
+
+void SlabPool::deallocate(void* ptr) {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    FreeBlock* block = static_cast<FreeBlock*>(ptr);
+    block->next = m_FreeList;
+    m_FreeList = block;
+    m_InUse--;
+}
+
+void SlabPool::addSlab() {
+    size_t slabBytes = m_BlockSize * m_BlocksPerSlab;
+    void* slab = nullptr;
+
+#ifdef __linux__
+    if (m_UseMmap) {
+        slab = mmap(nullptr, slabBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (slab == MAP_FAILED) throw std::bad_alloc();
+    }
+#endif
+    if (!slab) slab = ::operator new(slabBytes);
+
+    m_Slabs.push_back(slab);
+
+    // Thread the new blocks onto the free list, lowest address handed out first
+    char* base = static_cast<char*>(slab);
+    for (size_t i = m_BlocksPerSlab; i-- > 0;) {
+        FreeBlock* block = reinterpret_cast<FreeBlock*>(base + i * m_BlockSize);
+        block->next = m_FreeList;
+        m_FreeList = block;
+    }
+}
+
+SlabPool::Stats SlabPool::getStats() const {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return {m_Name, m_BlockSize, m_InUse, m_HighWater, m_Slabs.size() * m_BlocksPerSlab};
+}
+
+std::vector<SlabPool::Stats> SlabPool::getAllStats() {
+    std::lock_guard<std::mutex> lock(registryMutex());
+    std::vector<Stats> stats;
+    for (const SlabPool* pool : registry()) {
+        stats.push_back(pool->getStats());
+    }
+    return stats;
+}
+
+namespace ChunkMemory {
+    namespace {
+        constexpr int sizeClassCount() {
+            int count = 1;
+            for (size_t size = kMinBufferSize; size < kMaxBufferSize; size *= 2) count++;
+            return count;
+        }
+
+        constexpr int kSizeClasses = sizeClassCount();
+
+        int sizeClassFor(size_t bytes) {
+            int sizeClass = 0;
+            for (size_t size = kMinBufferSize; size < bytes; size *= 2) sizeClass++;
+            return sizeClass;
+        }
+
+        SlabPool& bufferPool(int sizeClass) {
+            static std::array<std::unique_ptr<SlabPool>, kSizeClasses> pools = [] {
+                std::array<std::unique_ptr<SlabPool>, kSizeClasses> p;
+                for (int i = 0; i < kSizeClasses; i++) {
+                    p[i] = std::make_unique<SlabPool>("buffer", kMinBufferSize << i, VOXEL_POOL_USE_MMAP);
+                }
+                return p;
+            }();
+            return *pools[sizeClass];
+        }
+    }
+
+    void* allocateBuffer(size_t bytes) {
+        if (bytes > kMaxBufferSize) return ::operator new(bytes);
+        return bufferPool(sizeClassFor(bytes)).allocate();
+    }
+
+    void deallocateBuffer(void* ptr, size_t bytes) {
+        if (bytes > kMaxBufferSize) {
+            ::operator delete(ptr);
+            return;
+        }
+        bufferPool(sizeClassFor(bytes)).deallocate(ptr);
+    }
+
+    SlabPool& objectPool(const char* name, size_t size) {
+        // Pools live for the whole program, chunks can outlive any one owner
+        static std::mutex mutex;
+        static std::vector<std::unique_ptr<SlabPool>> pools;
+
+        std::lock_guard<std::mutex> lock(mutex);
+        pools.push_back(std::make_unique<SlabPool>(name, size, VOXEL_POOL_USE_MMAP));
+        return *pools.back();
+    }
+}
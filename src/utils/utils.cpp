@@ -8,7 +8,7 @@ GLuint loadTexture(const char *path) {
 
     // flip rendering to top-to-bottom
     // this breaks texture mapping with the tiling setup for some reason. always maps to water.
-    // Currently newU and newV are just altered directly inside Block::remapFaceUV
+    // Currently v is flipped per tile in fragment.glsl instead
     // stbi_set_flip_vertically_on_load(1);
 
     int width, height, nrComponents;
@@ -1,6 +1,8 @@
 #include "World.hpp"
 #include "ChunkGenerator.hpp"
+#include "MeshCache.hpp"
 #include <iostream>
+#include <chrono>
 #include <ThreadPool.hpp>
 
 World::World(uint64_t seed) 
@@ -12,11 +14,18 @@ World::World(uint64_t seed)
         enqueueNearbyChunks(m_LastKnownPlayerChunk);
     };
 
+World::~World() {
+    // Mesh jobs push their results back into this World
+    std::unique_lock<std::mutex> lock(m_MeshJobsMutex);
+    m_MeshJobsDone.wait(lock, [this]() { return m_MeshJobsInFlight == 0; });
+}
+
 
 
 int maxPerFrame = 4;
 void World::update(float dt) {
     m_UnloadTimer += dt;
+    m_StatsTimer += dt;
     m_Player.update(dt);
 
     glm::ivec3 playerChunk = worldToChunkCoords(m_Player.getPosition());
@@ -26,6 +35,7 @@ void World::update(float dt) {
 
     if (playerChangedChunks) {
         m_LastKnownPlayerChunk = worldToChunkCoords(m_Player.getPosition());
+        updateChunkLods(playerChunk);
         ThreadPool::instance().enqueue([this, playerChunk]() {
             enqueueNearbyChunks(playerChunk);
             sortMeshingQueue(playerChunk);
@@ -42,15 +52,40 @@ void World::update(float dt) {
             m_QueuedChunks.erase(coords);
         }
 
-        Chunk* c = getChunk(coords.x, coords.y, coords.z);
-        if (c) {
-            std::lock_guard<std::mutex> lock(m_MeshQueueMutex);
-            if (m_MeshQueuedChunks.insert(coords).second)
-                m_MeshQueue.push(coords);
-        }
+        // New chunks are queued for meshing once their neighbors are in
+        getChunk(coords.x, coords.y, coords.z);
     }
 
-    for (int i = 0; i < maxPerFrame; i++) {
+    queueReadyFirstMeshes(playerChunk);
+    dispatchMeshJobs();
+    uploadFinishedMeshes();
+
+    if (m_StatsTimer >= STATS_INTERVAL) {
+        m_StatsTimer = 0.0f;
+        printStats();
+    }
+}
+
+void World::printStats() const {
+    std::cout << "Loaded Chunks: " << m_Chunks.size() << " | avg mesh: " << getAverageMeshMicros() << "us"
+              << " | meshes/chunk: " << getAverageMeshesPerChunk()
+              << " | occluded: " << m_OccludedChunks.size();
+    MeshCache::Stats cache = MeshCache::instance().getStats();
+    std::cout << " | mesh cache: " << cache.hits << " hits, " << cache.misses << " misses, "
+              << cache.entries << " entries, " << cache.bytes / 1024 << "KB" << std::endl;
+
+    // Blocks in use / capacity per pool, size classes nothing was allocated from are left out
+    std::cout << "Slab pools:";
+    for (const SlabPool::Stats& pool : SlabPool::getAllStats()) {
+        if (pool.capacity == 0) continue;
+        std::cout << " | " << pool.name << " " << pool.blockSize << "B: " << pool.inUse << "/" << pool.capacity
+                  << " (peak " << pool.highWater << ")";
+    }
+    std::cout << std::endl;
+}
+
+void World::dispatchMeshJobs() {
+    while (m_MeshJobsOutstanding < MAX_MESH_JOBS_IN_FLIGHT) {
         glm::ivec3 pos;
         {
             std::lock_guard<std::mutex> lock(m_MeshQueueMutex);
@@ -60,35 +95,164 @@ void World::update(float dt) {
             m_MeshQueuedChunks.erase(pos);
         }
 
-        Chunk* c = getChunkAtChunkPos(pos);
-        if (!c) continue;
+        auto it = m_Chunks.find(pos);
+        if (it == m_Chunks.end()) continue;
+        std::shared_ptr<Chunk> chunk = it->second;
 
-        c->generateMesh();
+        // Only the directions marked dirty get rebuilt, the job reuses the rest
+        uint8_t dirtyFaces = chunk->getDirtyFaces();
+        if (dirtyFaces == 0) continue;
 
-        // Regenerate neighbor meshes (if not queued already)
+        // Nothing inside can be seen, free its mesh instead of rebuilding it
+        if (isChunkBuried(pos)) {
+            chunk->releaseMesh();
+            m_OccludedChunks.insert(pos);
+            m_LatestMeshTicket.erase(pos);
+            continue;
+        }
+        // It may have been buried before and come back through another path
+        m_OccludedChunks.erase(pos);
+
+        Chunk::FaceMeshes previous = chunk->getFaceMeshes();
+
+        // Neighbors and LODs are resolved here, the job never touches m_Chunks
+        std::array<std::shared_ptr<const Chunk>, 6> neighbors;
+        Chunk::NeighborLods neighborLods{};
         for (int f = 0; f < 6; f++) {
-            glm::ivec3 neighborPos = pos + Chunk::neighborOffsets[f];
-            if (m_MeshQueuedChunks.find(neighborPos) == m_MeshQueuedChunks.end()) {
-                Chunk* n = getChunkAtChunkPos(neighborPos);
-                if (!n) continue;
-                std::lock_guard<std::mutex> lock(m_MeshQueueMutex);
-                if (m_MeshQueuedChunks.insert(neighborPos).second) {
-                    m_MeshQueue.push(neighborPos);
-                }
+            auto n = m_Chunks.find(pos + Chunk::neighborOffsets[f]);
+            if (n == m_Chunks.end()) continue;
+            neighbors[f] = n->second;
+            neighborLods[f] = n->second->getLod();
+        }
+        uint8_t lod = chunk->getLod();
+
+        uint64_t ticket = ++m_NextMeshTicket;
+        m_LatestMeshTicket[pos] = ticket;
+        m_MeshJobsOutstanding++;
+        m_MeshJobsInFlight++;
+
+        ThreadPool::instance().enqueue([this, pos, chunk, neighbors, neighborLods, lod, ticket, dirtyFaces, previous]() mutable {
+            Chunk::Neighbors rawNeighbors;
+            for (int f = 0; f < 6; f++) rawNeighbors[f] = neighbors[f].get();
+
+            auto meshStart = std::chrono::steady_clock::now();
+            Chunk::MeshBuild build = chunk->buildMesh(rawNeighbors, neighborLods, lod, dirtyFaces, previous);
+            double micros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - meshStart).count();
+
+            {
+                std::lock_guard<std::mutex> lock(m_UploadQueueMutex);
+                // Moved, not copied, so the job itself holds no chunk once it is queued
+                m_UploadQueue.push_back({pos, std::move(chunk), std::move(neighbors), ticket, std::move(build), micros});
             }
+            // Notified under the lock so ~World can't return before the job is done with it
+            std::lock_guard<std::mutex> lock(m_MeshJobsMutex);
+            m_MeshJobsInFlight--;
+            m_MeshJobsDone.notify_all();
+        });
+    }
+}
+
+void World::uploadFinishedMeshes() {
+    int uploads = 0;
+    while (uploads < MAX_MESH_UPLOADS_PER_FRAME) {
+        MeshUpload upload;
+        {
+            std::lock_guard<std::mutex> lock(m_UploadQueueMutex);
+            if (m_UploadQueue.empty()) break;
+            upload = std::move(m_UploadQueue.front());
+            m_UploadQueue.pop_front();
+        }
+        // The slot frees up whether the result is uploaded or dropped
+        m_MeshJobsOutstanding--;
+        m_MeshMicrosTotal += upload.micros;
+        m_MeshedChunks++;
+
+        // Skip chunks that were unloaded, or that a newer job is already remeshing.
+        // Dropping them here also releases their chunk and neighbors on the main thread
+        auto it = m_Chunks.find(upload.pos);
+        if (it == m_Chunks.end() || it->second != upload.chunk) continue;
+        auto latest = m_LatestMeshTicket.find(upload.pos);
+        if (latest == m_LatestMeshTicket.end() || latest->second != upload.ticket) continue;
+        m_LatestMeshTicket.erase(latest);
+
+        if (upload.chunk->getMeshCount() == 0) m_FirstMeshes++;
+        else m_Remeshes++;
+        upload.chunk->uploadMesh(std::move(upload.build));
+        uploads++;
+    }
+}
+
+uint8_t World::lodForChunk(const glm::ivec3& playerChunkPos, const glm::ivec3& chunkCoord) const {
+    // Chebyshev distance in 16 block units, like VIEW_DISTANCE
+    glm::ivec3 blocks = glm::abs(chunkCoord - playerChunkPos) * glm::ivec3(Chunk::kChunkWidth, Chunk::kChunkHeight, Chunk::kChunkDepth);
+    int distance = std::max({blocks.x, blocks.y, blocks.z}) / 16;
+
+    uint8_t lod = 0;
+    while (lod < Chunk::kMaxLod && distance > LOD_DISTANCES[lod]) lod++;
+    return lod;
+}
+
+void World::updateChunkLods(const glm::ivec3& playerChunkPos) {
+    for (const auto& [pos, chunk] : m_Chunks) {
+        uint8_t lod = lodForChunk(playerChunkPos, pos);
+        if (lod == chunk->getLod()) continue;
+
+        chunk->setLod(lod);
+        // Chunks still waiting for their first mesh keep waiting, queueReadyFirstMeshes
+        // meshes them at whatever LOD they have by then
+        if (!m_PendingFirstMesh.count(pos)) queueChunkForRemeshing(pos);
+        // The seam changed too, neighbors rebuild the direction facing this chunk
+        for (int face = 0; face < 6; ++face) {
+            markChunkFaceDirty(pos + Chunk::neighborOffsets[face], face ^ 1);
         }
     }
+}
+
+bool World::isChunkBuried(const glm::ivec3& chunkCoord) const {
+    for (int face = 0; face < 6; ++face) {
+        auto it = m_Chunks.find(chunkCoord + Chunk::neighborOffsets[face]);
+        if (it == m_Chunks.end()) return false;
+        // The neighbor's layer against this chunk is across face ^ 1 from it
+        if (!(it->second->getSolidFaces() & (1 << (face ^ 1)))) return false;
+    }
+    return true;
+}
+
+bool World::isChunkResolved(const glm::ivec3& playerChunkPos, const glm::ivec3& chunkCoord) const {
+    // Out of view chunks never generate, meshing treats them as air like air chunks
+    return !isChunkInView(playerChunkPos, chunkCoord) ||
+           m_Chunks.count(chunkCoord) || m_AirChunks.count(chunkCoord);
+}
+
+void World::queueReadyFirstMeshes(const glm::ivec3& playerChunkPos) {
+    auto now = std::chrono::steady_clock::now();
+    for (auto it = m_PendingFirstMesh.begin(); it != m_PendingFirstMesh.end();) {
+        bool ready = true;
+        if (now < it->second) {
+            for (int face = 0; face < 6; ++face) {
+                if (!isChunkResolved(playerChunkPos, it->first + Chunk::neighborOffsets[face])) {
+                    ready = false;
+                    break;
+                }
+            }
+        }
 
-    std::cout << "Loaded Chunks: " << m_Chunks.size() << std::endl;
+        if (ready) {
+            queueChunkForRemeshing(it->first);
+            it = m_PendingFirstMesh.erase(it);
+        } else {
+            ++it;
+        }
+    }
 }
 
 void World::enqueueNearbyChunks(const glm::ivec3& playerChunkPos) {
     std::vector<glm::ivec3> candidates;
     std::unordered_set<glm::ivec3> visibleNow;
 
-    for (int dx = -VIEW_DISTANCE; dx <= VIEW_DISTANCE; ++dx) {
-        for (int dy = -VIEW_DISTANCE; dy <= VIEW_DISTANCE; ++dy) {
-            for (int dz = -VIEW_DISTANCE; dz <= VIEW_DISTANCE; ++dz) {
+    for (int dx = -VIEW_EXTENT.x; dx <= VIEW_EXTENT.x; ++dx) {
+        for (int dy = -VIEW_EXTENT.y; dy <= VIEW_EXTENT.y; ++dy) {
+            for (int dz = -VIEW_EXTENT.z; dz <= VIEW_EXTENT.z; ++dz) {
                 glm::ivec3 pos = playerChunkPos + glm::ivec3(dx, dy, dz);
                 visibleNow.insert(pos);
                 {
@@ -171,9 +335,7 @@ Chunk* World::getChunk(int cx, int cy, int cz) {
     {
         std::lock_guard<std::mutex> lock(m_ChunkMutex);
         // first search known air chunks
-        for (size_t i = 0; i < m_AirChunks.size(); i++) {
-            if (key == m_AirChunks[i]) return nullptr;
-        }
+        if (m_AirChunks.count(key)) return nullptr;
 
         // now search cached chunks
         auto it = m_Chunks.find(key);
@@ -185,7 +347,7 @@ Chunk* World::getChunk(int cx, int cy, int cz) {
 
     if (m_ChunkGenerator.isChunkEmpty(cx, cy, cz)) {
         std::lock_guard<std::mutex> lock(m_ChunkMutex);
-        m_AirChunks.push_back(key);
+        m_AirChunks.insert(key);
         return nullptr;
     }
 
@@ -195,33 +357,38 @@ Chunk* World::getChunk(int cx, int cy, int cz) {
     // If the chunk only contains air mark it for future reference
     if (newChunk == nullptr) {
         std::lock_guard<std::mutex> lock(m_ChunkMutex);
-        m_AirChunks.push_back(key);
+        m_AirChunks.insert(key);
         return nullptr;
     }
 
+    Chunk* chunkPtr = newChunk.get();
+    chunkPtr->setLod(lodForChunk(m_LastKnownPlayerChunk, key));
     {
         std::lock_guard<std::mutex> lock(m_ChunkMutex);
         // Store valid chunks in the chunk map
-        Chunk* chunkPtr = newChunk.get();
         m_Chunks[key] = std::move(newChunk);
-        return chunkPtr;
     }
 
-    // std::cout << "Chunks map size: "<< m_Chunks.size() << std::endl;
+    m_PendingFirstMesh[key] = std::chrono::steady_clock::now() + MESH_NEIGHBOR_DEADLINE;
 
-    // Ask all neighboring chunks to re-check their meshing on the face
-    // facing toward this chunk
+    // Neighbors already meshed were meshed with this chunk as air. Only the
+    // direction facing it needs a rebuild, and only if it now hides a face
     // Face indices: 0 = -Z, 1 = +Z, 2 = -X, 3 = +X, 4 = -Y, 5 = +Y
-    /*for (int face = 0; face < 6; ++face) {
-        glm::ivec3 offset = Chunk::neighborOffsets[face];
-        glm::ivec3 neighborPos = key + offset;
+    for (int face = 0; face < 6; ++face) {
+        glm::ivec3 neighborPos = key + Chunk::neighborOffsets[face];
+        if (m_PendingFirstMesh.count(neighborPos)) continue; // Its first mesh will see this chunk
 
         auto it = m_Chunks.find(neighborPos);
-        if (it != m_Chunks.end()) {
-            markChunkFaceDirty(neighborPos, face ^ 1); // mark neighbor’s face that borders this chunk
-        }
-    }*/
+        if (it == m_Chunks.end()) continue;
+        // Across an LOD seam both sides keep all their faces, nothing to rebuild.
+        // Coarse borders differ from the blocks, so same-LOD coarse neighbors always rebuild
+        const Chunk& neighbor = *it->second;
+        if (neighbor.getLod() != chunkPtr->getLod()) continue;
+        if (neighbor.getLod() == 0 && !neighbor.isBorderHiddenBy(*chunkPtr, face ^ 1)) continue;
+        markChunkFaceDirty(neighborPos, face ^ 1);
+    }
 
+    return chunkPtr;
 }
 
 void World::unloadOutdatedChunks(const glm::ivec3& playerChunkPos) {
@@ -232,6 +399,9 @@ void World::unloadOutdatedChunks(const glm::ivec3& playerChunkPos) {
         // Remove generated chunks outside view
         for (auto it = m_Chunks.begin(); it != m_Chunks.end();) {
             if (!isChunkInView(playerChunkPos, it->first)) {
+                m_LatestMeshTicket.erase(it->first); // Drops any mesh still being built for it
+                m_PendingFirstMesh.erase(it->first);
+                m_OccludedChunks.erase(it->first);
                 it = m_Chunks.erase(it);
             } else {
                 it++;
@@ -239,14 +409,30 @@ void World::unloadOutdatedChunks(const glm::ivec3& playerChunkPos) {
         }
 
         // Remove old air chunks as well
-        m_AirChunks.erase(std::remove_if(m_AirChunks.begin(), m_AirChunks.end(),
-                    [&](const glm::ivec3& pos) {
-                    return !isChunkInView(playerChunkPos, pos);
-                    }), m_AirChunks.end());
+        for (auto it = m_AirChunks.begin(); it != m_AirChunks.end();) {
+            if (!isChunkInView(playerChunkPos, *it)) {
+                it = m_AirChunks.erase(it);
+            } else {
+                it++;
+            }
+        }
     }
 }
 
 void World::queueChunkForRemeshing(const glm::ivec3& pos) {
+    // A job already running may have missed the new dirty faces, make it stale
+    m_LatestMeshTicket.erase(pos);
+    pushMeshQueue(pos);
+
+    // This chunk may have opened up a buried neighbor, have it checked again
+    for (int face = 0; face < 6; ++face) {
+        glm::ivec3 neighborPos = pos + Chunk::neighborOffsets[face];
+        if (m_OccludedChunks.erase(neighborPos)) pushMeshQueue(neighborPos);
+    }
+}
+
+void World::pushMeshQueue(const glm::ivec3& pos) {
+    std::lock_guard<std::mutex> lock(m_MeshQueueMutex);
     if (m_MeshQueuedChunks.insert(pos).second) {
         m_MeshQueue.push(pos);
     }
@@ -266,18 +452,28 @@ void World::markChunkFaceDirty(const glm::ivec3& chunkCoord, int faceIndex) {
     if (it == m_Chunks.end()) return;
 
     it->second->markFaceDirty(faceIndex);
-
-    if (m_MeshQueuedChunks.insert(chunkCoord).second) {
-        m_MeshQueue.push(chunkCoord);
-    }
+    // Chunks still waiting for their first mesh get queued once their neighbors are in
+    if (!m_PendingFirstMesh.count(chunkCoord)) queueChunkForRemeshing(chunkCoord);
 }
 
-void World::draw() {
+void World::draw(ShaderProgram& shader) {
+    // Directions facing away from the camera are skipped per chunk instead of culled on the GPU
+    const glm::vec3 cameraPos = m_Player.getCamera()->getPosition();
+    // Set once per chunk, so the location is looked up once per frame
+    const GLint transformLocation = shader.getUniformLocation("transform");
     for (const auto& [coord, chunk] : m_Chunks) {
-        chunk->draw();
+        chunk->draw(transformLocation, cameraPos, chunk->getFacesTowards(cameraPos));
     }
 }
 
+double World::getAverageMeshMicros() const {
+    return m_MeshedChunks ? m_MeshMicrosTotal / m_MeshedChunks : 0.0;
+}
+
+double World::getAverageMeshesPerChunk() const {
+    return m_FirstMeshes ? static_cast<double>(m_FirstMeshes + m_Remeshes) / m_FirstMeshes : 0.0;
+}
+
 Player* World::getPlayer() {
     return &m_Player;
 }
@@ -295,6 +491,7 @@ BlockType World::getBlockAtWorld(const glm::ivec3& pos) const {
 
     return it->second->getBlock(localCoords.x, localCoords.y, localCoords.z);
 }
+
 Chunk* World::getChunkAtWorld(const glm::ivec3& pos) const {
     glm::ivec3 chunkCoords = worldToChunkCoords(glm::vec3(pos.x, pos.y, pos.z));
     auto it = m_Chunks.find(chunkCoords);
@@ -312,5 +509,5 @@ Chunk* World::getChunkAtChunkPos(const glm::ivec3& chunkCoords) const {
 
 bool World::isChunkInView(const glm::ivec3& playerChunk, const glm::ivec3& chunkCoord) const {
     glm::ivec3 d = glm::abs(chunkCoord - playerChunk);
-    return d.x <= VIEW_DISTANCE && d.y <= VIEW_DISTANCE && d.z <= VIEW_DISTANCE;
+    return d.x <= VIEW_EXTENT.x && d.y <= VIEW_EXTENT.y && d.z <= VIEW_EXTENT.z;
 }